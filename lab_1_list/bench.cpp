@@ -0,0 +1,955 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "compact_list.h"
+#include "concurrent_list.h"
+#include "concurrent_queue.h"
+#include "hashed_list.h"
+#include "intrusive_list.h"
+#include "list.h"
+#include "lru_cache.h"
+#include "ranked_list.h"
+#include "slab_allocator.h"
+#include "timing_wheel.h"
+#include "unrolled_list.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Результаты вычислений сохраняются сюда, чтобы компилятор их не выбросил
+volatile long long sink;
+
+template <typename F>
+double measure_ms(F &&f) {
+  auto start = clock_type::now();
+  f();
+  std::chrono::duration<double, std::milli> d = clock_type::now() - start;
+  return d.count();
+}
+
+void report(char const *name, double base_ms, double tuned_ms) {
+  std::printf("%-32s %10.2f ms %10.2f ms %8.2fx\n", name, base_ms, tuned_ms,
+              base_ms / tuned_ms);
+}
+
+// Очередь: список держит window элементов, каждая операция — push_back и
+// pop_front, т.е. одно выделение и одно освобождение узла
+template <typename List>
+double bench_queue(std::size_t window, std::size_t ops) {
+  List l;
+  for (std::size_t i = 0; i < window; i++) l.push_back(static_cast<int>(i));
+
+  return measure_ms([&] {
+    for (std::size_t i = 0; i < ops; i++) {
+      l.push_back(static_cast<int>(i));
+      l.pop_front();
+    }
+  });
+}
+
+// Построение списка из n элементов и его очистка
+template <typename List>
+double bench_fill_clear(std::size_t n, std::size_t rounds) {
+  List l;
+  return measure_ms([&] {
+    for (std::size_t r = 0; r < rounds; r++) {
+      for (std::size_t i = 0; i < n; i++) l.push_back(static_cast<int>(i));
+      l.clear();
+    }
+  });
+}
+
+void bench_allocators() {
+  using std_list = list<int>;
+  using slab_list = list<int, slab_allocator<int>>;
+
+  std::printf("%-32s %13s %13s %9s\n", "list<int>", "std::allocator",
+              "slab", "speedup");
+
+  report("queue, window 1000, 10^7 ops",
+         bench_queue<std_list>(1000, 10000000),
+         bench_queue<slab_list>(1000, 10000000));
+  report("fill+clear 10^6 x 10", bench_fill_clear<std_list>(1000000, 10),
+         bench_fill_clear<slab_list>(1000000, 10));
+  report("fill+clear 10^3 x 10^4", bench_fill_clear<std_list>(1000, 10000),
+         bench_fill_clear<slab_list>(1000, 10000));
+}
+
+template <typename List>
+void fill(List &l, std::size_t n) {
+  for (std::size_t i = 0; i < n; i++) l.push_back(static_cast<int>(i));
+}
+
+template <typename List>
+double bench_sum(List &l, std::size_t rounds) {
+  long long sum = 0;
+  double ms = measure_ms([&] {
+    for (std::size_t r = 0; r < rounds; r++) {
+      for (auto it = l.begin(); it != l.end(); ++it) sum += *it;
+    }
+  });
+  sink = sum;
+  return ms;
+}
+
+template <typename List>
+double bench_contains(List &l, std::size_t rounds) {
+  long long found = 0;
+  double ms = measure_ms([&] {
+    for (std::size_t r = 0; r < rounds; r++) found += l.contains(-1);
+  });
+  sink = found;
+  return ms;
+}
+
+void bench_unrolled() {
+  const std::size_t n = 10000000;
+  list<int> plain;
+  unrolled_list<int> unrolled;
+  fill(plain, n);
+  fill(unrolled, n);
+
+  std::printf("\n%-32s %13s %13s %9s\n", "10^7 ints", "list", "unrolled",
+              "speedup");
+  report("traversal via iterators x 5", bench_sum(plain, 5),
+         bench_sum(unrolled, 5));
+  report("contains (miss) x 5", bench_contains(plain, 5),
+         bench_contains(unrolled, 5));
+}
+
+// Аллокатор, считающий выданные байты (без служебных данных malloc)
+std::size_t tracked_bytes = 0;
+
+template <typename T>
+struct tracking_allocator {
+  using value_type = T;
+
+  tracking_allocator() = default;
+  template <typename U>
+  tracking_allocator(tracking_allocator<U> const &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    tracked_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) noexcept {
+    tracked_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  bool operator==(tracking_allocator const &) const noexcept { return true; }
+  bool operator!=(tracking_allocator const &) const noexcept { return false; }
+};
+
+// Перемешивание порядка узлов в памяти: удаляется каждый второй элемент,
+// затем в хвост добавляется столько же новых
+template <typename List>
+void fragment(List &l) {
+  std::size_t n = l.size();
+  for (auto it = l.begin(); it != l.end();) {
+    auto next = it;
+    ++next;
+    l.erase(it);
+    it = next;
+    if (it != l.end()) ++it;
+  }
+  for (std::size_t i = 0; i < n / 2; i++) l.push_back(static_cast<int>(i));
+}
+
+void bench_compact() {
+  const std::size_t n = 10000000;
+  list<int, tracking_allocator<int>> plain;
+  compact_list<int> compact;
+  fill(plain, n);
+  fill(compact, n);
+  compact.shrink_to_fit();
+
+  std::printf("\n%-32s %13s %13s %9s\n", "10^7 ints", "list", "compact",
+              "speedup");
+  std::printf("%-32s %10.2f B  %10.2f B\n", "memory per element",
+              static_cast<double>(tracked_bytes) / static_cast<double>(n),
+              static_cast<double>(compact.memory_usage()) /
+                  static_cast<double>(n));
+  report("traversal x 5", bench_sum(plain, 5), bench_sum(compact, 5));
+
+  fragment(plain);
+  fragment(compact);
+  report("traversal x 5, fragmented", bench_sum(plain, 5),
+         bench_sum(compact, 5));
+  double shrink_ms = measure_ms([&] { compact.shrink_to_fit(); });
+  report("traversal x 5, after shrink", bench_sum(plain, 5),
+         bench_sum(compact, 5));
+  std::printf("%-32s %27.2f ms\n", "shrink_to_fit", shrink_ms);
+}
+
+// Случайные обращения, вставки и удаления по номеру
+template <typename List>
+double bench_positional(std::size_t n, std::size_t ops) {
+  List l;
+  fill(l, n);
+
+  std::uint32_t x = 12345;
+  auto next = [&x](std::size_t bound) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x % bound;
+  };
+
+  long long sum = 0;
+  double ms = measure_ms([&] {
+    for (std::size_t i = 0; i < ops; i++) {
+      sum += l.at(next(l.size()));
+      l.erase(next(l.size()));
+      l.emplace(next(l.size() + 1), static_cast<int>(i));
+    }
+  });
+  sink = sum;
+  return ms;
+}
+
+void bench_ranked() {
+  std::printf("\n%-32s %13s %13s %9s\n", "at/erase/emplace by index", "list",
+              "ranked", "speedup");
+  report("10^4 elements, 10^4 ops", bench_positional<list<int>>(10000, 10000),
+         bench_positional<ranked_list<int>>(10000, 10000));
+  report("10^5 elements, 10^3 ops", bench_positional<list<int>>(100000, 1000),
+         bench_positional<ranked_list<int>>(100000, 1000));
+}
+
+template <typename List>
+double contains_ns(List &l, std::size_t ops) {
+  long long found = 0;
+  double ms = measure_ms([&] {
+    for (std::size_t i = 0; i < ops; i++) {
+      found += l.contains(static_cast<int>(l.size() + i));
+    }
+  });
+  sink = found;
+  return ms * 1e6 / static_cast<double>(ops);
+}
+
+void bench_hashed() {
+  std::printf("\n%-10s %16s %16s %18s %14s\n", "elements",
+              "list miss", "hashed miss", "hashed remove+push",
+              "index B/elem");
+
+  for (std::size_t n = 1000; n <= 10000000; n *= 10) {
+    double plain_ns;
+    {
+      list<int> l;
+      fill(l, n);
+      plain_ns = contains_ns(l, std::max<std::size_t>(10, 100000000 / n));
+    }
+
+    hashed_list<int> h;
+    fill(h, n);
+    double hashed_ns = contains_ns(h, 1000000);
+
+    const std::size_t ops = 1000000;
+    double remove_ms = measure_ms([&] {
+      for (std::size_t i = 0; i < ops; i++) {
+        int v = static_cast<int>(i * 7919 % n);
+        h.remove_value(v);
+        h.push_back(v);
+      }
+    });
+
+    std::printf("%-10zu %13.1f ns %13.1f ns %15.1f ns %14.1f\n", n, plain_ns,
+                hashed_ns, remove_ms * 1e6 / static_cast<double>(ops),
+                static_cast<double>(h.index_memory_usage()) /
+                    static_cast<double>(n));
+  }
+}
+
+// Сортировка через вектор: копирование, std::sort, пересборка списка
+template <typename V>
+void sort_via_vector(list<V> &l) {
+  std::vector<V> v;
+  v.reserve(l.size());
+  for (auto it = l.begin(); it != l.end(); ++it) v.push_back(*it);
+  std::sort(v.begin(), v.end());
+
+  list<V> sorted;
+  for (auto const &x : v) sorted.push_back(x);
+  l.swap(sorted);
+}
+
+void bench_sort() {
+  const std::size_t n = 2000000;
+  std::mt19937 gen(42);
+  list<int> source;
+  for (std::size_t i = 0; i < n; i++) {
+    source.push_back(static_cast<int>(gen() % 1000000));
+  }
+
+  list<int> a(source), b(source), c(source);
+  double vector_ms = measure_ms([&] { sort_via_vector(a); });
+  double sort_ms = measure_ms([&] { b.sort(); });
+  double parallel_ms = measure_ms([&] { c.parallel_sort(); });
+
+  std::printf("\n%-32s %13s %13s %9s\n", "sort 2*10^6 random ints", "vector",
+              "list::sort", "speedup");
+  report("list::sort", vector_ms, sort_ms);
+  std::printf("%-32s %13s %10.2f ms (%u threads)\n", "list::parallel_sort", "",
+              parallel_ms, std::thread::hardware_concurrency());
+
+  list<std::string> strings;
+  for (std::size_t i = 0; i < n / 4; i++) {
+    strings.push_back(std::string(48, 'k') + std::to_string(gen()));
+  }
+  list<std::string> d(strings), e(strings);
+  report("5*10^5 48-char strings", measure_ms([&] { sort_via_vector(d); }),
+         measure_ms([&] { e.sort(); }));
+}
+
+// Построение списка из вектора: поэлементный push_back против конструктора
+// из диапазона
+template <typename List>
+void bench_build_row(char const *name, std::vector<int> const &v,
+                     std::size_t rounds) {
+  double push_ms = measure_ms([&] {
+    for (std::size_t r = 0; r < rounds; r++) {
+      List l;
+      for (int x : v) l.push_back(x);
+    }
+  });
+  double range_ms = measure_ms([&] {
+    for (std::size_t r = 0; r < rounds; r++) {
+      List l(v.begin(), v.end());
+    }
+  });
+  report(name, push_ms, range_ms);
+}
+
+void bench_build() {
+  std::vector<int> v(1000000);
+  for (std::size_t i = 0; i < v.size(); i++) v[i] = static_cast<int>(i);
+
+  std::printf("\n%-32s %13s %13s %9s\n", "build 10^6 ints x 10", "push_back",
+              "range ctor", "speedup");
+  bench_build_row<list<int>>("std::allocator", v, 10);
+  bench_build_row<list<int, slab_allocator<int>>>("slab", v, 10);
+}
+
+// Удаление по условию: поэлементный erase во время обхода против одного
+// прохода remove_if с освобождением узлов пачкой в конце
+template <typename List>
+void bench_remove_row(char const *name, std::size_t n) {
+  List a, b;
+  fill(a, n);
+  fill(b, n);
+  auto odd = [](int x) { return x % 2 != 0; };
+
+  double erase_ms = measure_ms([&] {
+    for (auto it = a.begin(); it != a.end();) {
+      auto next = it;
+      ++next;
+      if (odd(*it)) a.erase(it);
+      it = next;
+    }
+  });
+  double remove_ms = measure_ms([&] { b.remove_if(odd); });
+  report(name, erase_ms, remove_ms);
+}
+
+// Дорогой предикат: параллельное вычисление по участкам
+void bench_parallel_remove() {
+  const std::size_t n = 2000000;
+  list<int> a, b;
+  fill(a, n);
+  fill(b, n);
+  auto costly = [](int x) {
+    unsigned h = static_cast<unsigned>(x);
+    for (int i = 0; i < 200; i++) h = h * 2654435761u + 1;
+    return (h & 1) != 0;
+  };
+
+  report("2*10^6, costly predicate", measure_ms([&] { a.remove_if(costly); }),
+         measure_ms([&] { b.parallel_remove_if(costly); }));
+}
+
+void bench_remove() {
+  std::printf("\n%-32s %13s %13s %9s\n", "remove odd values", "erase loop",
+              "remove_if", "speedup");
+  bench_remove_row<list<int>>("10^7, std::allocator", 10000000);
+  bench_remove_row<list<int, slab_allocator<int>>>("10^7, slab", 10000000);
+
+  std::printf("\n%-32s %13s %13s %9s\n", "remove_if", "serial",
+              "parallel", "speedup");
+  bench_parallel_remove();
+}
+
+// Объекты из собственного пула гоняются по кругу через очередь: list
+// выделяет узел и копирует объект, intrusive_list только перецепляет крючок
+struct pooled_item {
+  long long payload[4];
+  list_hook hook;
+};
+
+void bench_intrusive() {
+  const std::size_t window = 1000, ops = 10000000;
+  std::vector<pooled_item> pool(window);
+  for (std::size_t i = 0; i < window; i++) {
+    pool[i].payload[0] = static_cast<long long>(i);
+  }
+
+  list<pooled_item> copies;
+  intrusive_list<pooled_item, &pooled_item::hook> linked;
+  for (auto &item : pool) {
+    copies.push_back(item);
+    linked.push_back(item);
+  }
+
+  double list_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < ops; i++) {
+      copies.push_back(copies.front());
+      copies.pop_front();
+    }
+  });
+  double intrusive_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < ops; i++) linked.push_back(linked.front());
+  });
+
+  std::printf("\n%-32s %13s %13s %9s\n", "rotate pooled objects", "list",
+              "intrusive", "speedup");
+  report("window 1000, 10^7 ops", list_ms, intrusive_ms);
+}
+
+// Истечение таймаутов: список (момент, id), на каждом тике remove_if по
+// всему списку, против колеса таймеров
+void bench_timer_scan() {
+  const std::size_t timers = 100000, ticks = 1000;
+  std::mt19937 rng(11);
+  std::vector<std::uint64_t> expires(timers);
+  for (auto &e : expires) e = 1 + rng() % ticks;
+
+  long long fired = 0;
+  list<std::pair<std::uint64_t, int>> scanned;
+  for (std::size_t i = 0; i < timers; i++) {
+    scanned.push_back({expires[i], static_cast<int>(i)});
+  }
+  double scan_ms = measure_ms([&] {
+    for (std::uint64_t now = 1; now <= ticks; now++) {
+      fired += static_cast<long long>(scanned.remove_if(
+          [now](auto const &t) { return t.first <= now; }));
+    }
+  });
+
+  timing_wheel<int> wheel;
+  for (std::size_t i = 0; i < timers; i++) {
+    wheel.schedule(expires[i], static_cast<int>(i));
+  }
+  double wheel_ms = measure_ms([&] {
+    for (std::uint64_t now = 1; now <= ticks; now++) {
+      fired += static_cast<long long>(wheel.advance(now, [](int) {}));
+    }
+  });
+  sink = fired;
+
+  std::printf("\n%-32s %13s %13s %9s\n", "expiry, 10^5 timers", "list scan",
+              "wheel", "speedup");
+  report("1000 ticks", scan_ms, wheel_ms);
+}
+
+// Пропускная способность колеса при 10^7 ожидающих таймеров
+void bench_timing_wheel() {
+  const std::size_t timers = 10000000, cancels = 1000000;
+  const std::uint64_t horizon = 1000000;
+  std::mt19937 rng(13);
+
+  timing_wheel<int> wheel;
+  std::vector<timing_wheel<int>::handle> handles(timers);
+  std::vector<std::uint64_t> expires(timers);
+  for (auto &e : expires) e = 1 + rng() % horizon;
+
+  double schedule_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < timers; i++) {
+      handles[i] = wheel.schedule(expires[i], static_cast<int>(i));
+    }
+  });
+
+  std::vector<std::size_t> victims(cancels);
+  for (auto &v : victims) v = rng() % timers;
+  std::size_t cancelled = 0;
+  double cancel_ms = measure_ms([&] {
+    for (std::size_t v : victims) cancelled += wheel.cancel(handles[v]);
+  });
+
+  std::size_t expired = 0;
+  long long sum = 0;
+  double expire_ms = measure_ms([&] {
+    expired = wheel.advance(horizon, [&sum](int id) { sum += id; });
+  });
+  sink = sum;
+
+  auto ns_per = [](double ms, std::size_t n) {
+    return ms * 1e6 / static_cast<double>(n);
+  };
+  std::printf("\n%-32s %13s %13s\n", "timing wheel, 10^7 timers", "total",
+              "per timer");
+  std::printf("%-32s %10.2f ms %10.2f ns\n", "schedule", schedule_ms,
+              ns_per(schedule_ms, timers));
+  std::printf("%-32s %10.2f ms %10.2f ns\n", "cancel 10^6 by handle",
+              cancel_ms, ns_per(cancel_ms, cancelled));
+  std::printf("%-32s %10.2f ms %10.2f ns\n", "advance 10^6 ticks, expire",
+              expire_ms, ns_per(expire_ms, expired));
+}
+
+// Проверка срабатывания на границах ячеек: таймер, срок которого выпадает
+// на раскладку старшего уровня, должен сработать в свой тик, а не позже
+void check_timer_boundaries() {
+  const std::uint64_t expires[] = {1,     255,   256,   257,   511,  512,
+                                   513,   65535, 65536, 65537, 70000};
+  const std::size_t count = sizeof(expires) / sizeof(expires[0]);
+
+  timing_wheel<std::size_t> wheel;
+  for (std::size_t i = 0; i < count; i++) wheel.schedule(expires[i], i);
+
+  std::vector<std::uint64_t> fired(count, 0);
+  for (std::uint64_t now = 1; now <= expires[count - 1]; now++) {
+    wheel.advance(now, [&fired, now](std::size_t i) { fired[i] = now; });
+  }
+
+  std::printf("\n%-32s %10s %10s\n", "timing wheel slot boundaries",
+              "expires", "fired");
+  for (std::size_t i = 0; i < count; i++) {
+    std::printf("%-32s %10llu %10llu\n", fired[i] == expires[i] ? "ok" : "LATE",
+                static_cast<unsigned long long>(expires[i]),
+                static_cast<unsigned long long>(fired[i]));
+  }
+}
+
+// Очередь-эталон: list под одним мьютексом
+struct locked_queue {
+  std::mutex m;
+  list<int> l;
+
+  void push(int value) {
+    std::lock_guard<std::mutex> lock(m);
+    l.push_back(value);
+  }
+
+  bool try_pop(int &value) {
+    std::lock_guard<std::mutex> lock(m);
+    if (l.empty()) return false;
+    value = l.front();
+    l.pop_front();
+    return true;
+  }
+};
+
+// Половина потоков производит, половина потребляет; один поток делает и то
+// и другое. Возвращает миллионы операций (push + pop) в секунду
+template <typename Queue>
+double queue_throughput(std::size_t threads, std::size_t items) {
+  Queue q;
+  std::size_t producers = threads > 1 ? threads / 2 : 1;
+  std::size_t consumers = threads > 1 ? threads - producers : 0;
+  std::size_t per_producer = items / producers;
+  std::atomic<std::size_t> consumed{0};
+  std::size_t total = per_producer * producers;
+  // Потоки складывают результаты сюда, в sink пишется один раз после join
+  std::atomic<long long> popped_sum{0};
+
+  auto consume = [&] {
+    int value;
+    long long sum = 0;
+    while (consumed.load(std::memory_order_relaxed) < total) {
+      if (q.try_pop(value)) {
+        sum += value;
+        consumed.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    popped_sum.fetch_add(sum, std::memory_order_relaxed);
+  };
+
+  double ms = measure_ms([&] {
+    std::vector<std::thread> workers;
+    for (std::size_t p = 0; p < producers; p++) {
+      workers.emplace_back([&] {
+        for (std::size_t i = 0; i < per_producer; i++) {
+          q.push(static_cast<int>(i));
+        }
+      });
+    }
+    for (std::size_t c = 0; c < consumers; c++) workers.emplace_back(consume);
+    for (auto &w : workers) w.join();
+    if (consumers == 0) consume();
+  });
+  sink = popped_sum.load();
+
+  return 2.0 * static_cast<double>(total) / ms / 1000.0;
+}
+
+void bench_concurrent_queue() {
+  const std::size_t items = 1000000;
+
+  std::printf("\n%-10s %18s %18s %9s\n", "threads", "mutex+list Mops/s",
+              "lock-free Mops/s", "ratio");
+  for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+    double locked = queue_throughput<locked_queue>(threads, items);
+    double lock_free = queue_throughput<concurrent_queue<int>>(threads, items);
+    std::printf("%-10zu %18.2f %18.2f %8.2fx\n", threads, locked, lock_free,
+                lock_free / locked);
+  }
+}
+
+// Читатели многократно обходят список из 1000 элементов, один писатель
+// всё это время удаляет первый элемент и добавляет новый в конец.
+// Возвращает тысячи обходов в секунду по всем читателям
+template <typename Read, typename Write>
+double reader_throughput(std::size_t readers, std::size_t walks, Read read,
+                         Write write) {
+  std::atomic<std::size_t> active{readers};
+  std::atomic<long long> read_sum{0};
+  double ms = measure_ms([&] {
+    std::thread writer([&] {
+      int value = 0;
+      while (active.load(std::memory_order_relaxed) != 0) {
+        write(value++);
+        std::this_thread::yield();
+      }
+    });
+    std::vector<std::thread> workers;
+    for (std::size_t r = 0; r < readers; r++) {
+      workers.emplace_back([&] {
+        long long sum = 0;
+        for (std::size_t i = 0; i < walks; i++) sum += read();
+        read_sum.fetch_add(sum, std::memory_order_relaxed);
+        active.fetch_sub(1, std::memory_order_relaxed);
+      });
+    }
+    for (auto &w : workers) w.join();
+    writer.join();
+  });
+  sink = read_sum.load();
+  return static_cast<double>(readers * walks) / ms;
+}
+
+void bench_concurrent_list() {
+  const std::size_t size = 1000, walks = 20000;
+
+  std::printf("\n%-10s %18s %18s %9s\n", "readers", "rwlock kwalks/s",
+              "epoch kwalks/s", "ratio");
+  for (std::size_t readers = 1; readers <= 16; readers *= 2) {
+    std::shared_mutex m;
+    list<int> locked;
+    concurrent_list<int> shared;
+    for (std::size_t i = 0; i < size; i++) {
+      locked.push_back(static_cast<int>(i));
+      shared.push_back(static_cast<int>(i));
+    }
+
+    double rw = reader_throughput(
+        readers, walks,
+        [&] {
+          std::shared_lock<std::shared_mutex> lock(m);
+          long long sum = 0;
+          for (auto it = locked.begin(); it != locked.end(); ++it) sum += *it;
+          return sum;
+        },
+        [&](int value) {
+          std::unique_lock<std::shared_mutex> lock(m);
+          locked.pop_front();
+          locked.push_back(value);
+        });
+
+    double epoch = reader_throughput(
+        readers, walks,
+        [&] {
+          auto view = shared.read();
+          long long sum = 0;
+          for (int value : view) sum += value;
+          return sum;
+        },
+        [&](int value) {
+          {
+            auto view = shared.read();
+            shared.erase(view.begin());
+          }
+          shared.push_back(value);
+        });
+
+    std::printf("%-10zu %18.2f %18.2f %8.2fx\n", readers, rw, epoch,
+                epoch / rw);
+  }
+}
+
+// Поток ключей с распределением Ципфа: ключ k встречается с частотой
+// ~ 1 / (k + 1)^skew
+std::vector<int> zipf_keys(std::size_t keys, std::size_t count, double skew,
+                           unsigned seed) {
+  std::vector<double> cdf(keys);
+  double total = 0;
+  for (std::size_t k = 0; k < keys; k++) {
+    total += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+    cdf[k] = total;
+  }
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uniform(0, total);
+  std::vector<int> stream(count);
+  for (auto &key : stream) {
+    auto it = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng));
+    key = static_cast<int>(std::min<std::ptrdiff_t>(
+        it - cdf.begin(), static_cast<std::ptrdiff_t>(keys - 1)));
+  }
+  return stream;
+}
+
+// Кеш, собранный вручную: list и внешняя таблица, попадание — erase и
+// push_front, т.е. новый узел и копия значения на каждое обращение
+template <typename V>
+struct handmade_lru {
+  using entry = std::pair<int, V>;
+
+  std::size_t capacity;
+  list<entry> order;
+  std::unordered_map<int, typename list<entry>::iterator> index;
+
+  explicit handmade_lru(std::size_t cap) : capacity(cap) {}
+
+  V const *get(int key) {
+    auto found = index.find(key);
+    if (found == index.end()) return nullptr;
+    order.push_front(*found->second);
+    order.erase(found->second);
+    found->second = order.begin();
+    return &order.front().second;
+  }
+
+  void put(int key, V const &value) {
+    order.push_front(entry(key, value));
+    index.insert_or_assign(key, order.begin());
+    if (order.size() > capacity) {
+      index.erase(order.back().first);
+      order.pop_back();
+    }
+  }
+};
+
+// Обращение с подгрузкой при промахе. Возвращает долю попаданий
+template <typename Cache, typename V>
+double run_lru_stream(Cache &cache, std::vector<int> const &stream,
+                      V const &value) {
+  std::size_t hits = 0;
+  for (int key : stream) {
+    if (cache.get(key) != nullptr) {
+      hits++;
+    } else {
+      cache.put(key, value);
+    }
+  }
+  sink = static_cast<long long>(hits);
+  return static_cast<double>(hits) / static_cast<double>(stream.size());
+}
+
+template <typename V>
+void bench_lru_row(char const *name, std::vector<int> const &stream,
+                   std::size_t capacity, V const &value) {
+  handmade_lru<V> handmade(capacity);
+  lru_cache<int, V> tuned(capacity);
+  double handmade_rate = 0, tuned_rate = 0;
+  double handmade_ms = measure_ms(
+      [&] { handmade_rate = run_lru_stream(handmade, stream, value); });
+  double tuned_ms =
+      measure_ms([&] { tuned_rate = run_lru_stream(tuned, stream, value); });
+
+  report(name, handmade_ms, tuned_ms);
+  std::printf("%-32s %12.1f%% %12.1f%%\n", "  hit rate", 100 * handmade_rate,
+              100 * tuned_rate);
+}
+
+// Один lru_cache под общим мьютексом против sharded_lru_cache. Возвращает
+// миллионы обращений в секунду
+template <typename Get, typename Put>
+double lru_throughput(std::size_t threads, std::vector<int> const &stream,
+                      Get get, Put put) {
+  std::size_t part = stream.size() / threads;
+  double ms = measure_ms([&] {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        for (std::size_t i = t * part; i < (t + 1) * part; i++) {
+          if (!get(stream[i])) put(stream[i]);
+        }
+      });
+    }
+    for (auto &w : workers) w.join();
+  });
+  return static_cast<double>(part * threads) / ms / 1000.0;
+}
+
+void bench_lru() {
+  const std::size_t keys = 1000000, requests = 10000000, capacity = 100000;
+  auto stream = zipf_keys(keys, requests, 0.99, 7);
+
+  std::printf("\n%-32s %13s %13s %9s\n", "zipf 0.99, 10^6 keys, cap 10^5",
+              "list+map", "lru_cache", "speedup");
+  bench_lru_row("10^7 requests, int", stream, capacity, 0);
+  bench_lru_row("10^7 requests, 64-char string", stream, capacity,
+                std::string(64, 'v'));
+
+  lru_cache<int, int> counted(capacity);
+  run_lru_stream(counted, stream, 0);
+  auto stats = counted.stats();
+  std::printf("%-32s %zu hits, %zu misses, %zu evictions\n", "lru_cache stats",
+              stats.hits, stats.misses, stats.evictions);
+
+  std::printf("\n%-10s %18s %18s %9s\n", "threads", "mutex+lru Mops/s",
+              "sharded Mops/s", "ratio");
+  for (std::size_t threads = 1; threads <= 16; threads *= 2) {
+    std::mutex m;
+    lru_cache<int, int> single(capacity);
+    double locked = lru_throughput(
+        threads, stream,
+        [&](int key) {
+          std::lock_guard<std::mutex> lock(m);
+          return single.get(key) != nullptr;
+        },
+        [&](int key) {
+          std::lock_guard<std::mutex> lock(m);
+          single.put(key, key);
+        });
+
+    sharded_lru_cache<int, int> sharded(capacity);
+    double shards = lru_throughput(
+        threads, stream,
+        [&](int key) { return sharded.get(key).has_value(); },
+        [&](int key) { sharded.put(key, key); });
+
+    std::printf("%-10zu %18.2f %18.2f %8.2fx\n", threads, locked, shards,
+                shards / locked);
+  }
+}
+
+// Тип-счётчик: считает копирования и перемещения
+struct counted {
+  static inline std::size_t copies = 0;
+  static inline std::size_t moves = 0;
+
+  std::string payload;
+
+  counted(char const *s, std::size_t n) : payload(n, *s) {}
+  counted(counted const &other) : payload(other.payload) { copies++; }
+  counted(counted &&other) noexcept : payload(std::move(other.payload)) {
+    moves++;
+  }
+  counted &operator=(counted const &other) {
+    payload = other.payload;
+    copies++;
+    return *this;
+  }
+  counted &operator=(counted &&other) noexcept {
+    payload = std::move(other.payload);
+    moves++;
+    return *this;
+  }
+};
+
+// Аллокатор-счётчик выделений памяти. Счётчик общий для всех rebind
+std::size_t allocation_count = 0;
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator() = default;
+  template <typename U>
+  counting_allocator(counting_allocator<U> const &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    allocation_count++;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) noexcept {
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  bool operator==(counting_allocator const &) const noexcept { return true; }
+  bool operator!=(counting_allocator const &) const noexcept { return false; }
+};
+
+// Копирования, перемещения и выделения памяти для каждой операции
+// сравниваются с ожидаемыми: emplace не копирует и не перемещает,
+// push_back(T&&) только перемещает, перенос списка не трогает элементы.
+// Возвращает false, если хоть одна операция превысила ожидание
+bool count_copies() {
+  using counted_list = list<counted, counting_allocator<counted>>;
+  const std::size_t n = 1000;
+  bool passed = true;
+
+  auto row = [&passed](char const *name, std::size_t max_copies,
+                       std::size_t max_moves, std::size_t max_allocations,
+                       auto &&f) {
+    counted::copies = counted::moves = 0;
+    std::size_t before = allocation_count;
+    f();
+    std::size_t allocations = allocation_count - before;
+    bool ok = counted::copies <= max_copies && counted::moves <= max_moves &&
+              allocations <= max_allocations;
+    passed = passed && ok;
+    std::printf("%-32s %10zu %10zu %12zu %6s\n", name, counted::copies,
+                counted::moves, allocations, ok ? "ok" : "FAIL");
+  };
+
+  std::printf("\n%-32s %10s %10s %12s %6s\n", "list<counted>, 1000 elements",
+              "copies", "moves", "allocations", "check");
+
+  // Перенос и присваивание выделяют только пару ограничителей
+  counted_list l;
+  row("emplace_back(args)", 0, 0, n, [&] {
+    for (std::size_t i = 0; i < n; i++) l.emplace_back("x", 64);
+  });
+  row("push_back(T&&)", 0, n, n, [&] {
+    for (std::size_t i = 0; i < n; i++) l.push_back(counted("x", 64));
+  });
+  row("emplace_front(args)", 0, 0, n, [&] {
+    for (std::size_t i = 0; i < n; i++) l.emplace_front("x", 64);
+  });
+  row("move construction", 0, 0, 2,
+      [&] { counted_list moved(std::move(l)); });
+  counted_list a, b;
+  for (std::size_t i = 0; i < n; i++) a.emplace_back("x", 64);
+  row("move assignment", 0, 0, 2, [&] { b = std::move(a); });
+  row("copy assignment", n, 0, n + 2, [&] { a = b; });
+
+  if (!passed) std::printf("count_copies: extra copies or allocations\n");
+  return passed;
+}
+
+}  // namespace
+
+int main() {
+  bench_allocators();
+  bench_unrolled();
+  bench_compact();
+  bench_ranked();
+  bench_hashed();
+  bench_sort();
+  bench_build();
+  bench_remove();
+  bench_intrusive();
+  bench_timer_scan();
+  bench_timing_wheel();
+  check_timer_boundaries();
+  bench_concurrent_queue();
+  bench_concurrent_list();
+  bench_lru();
+  return count_copies() ? 0 : 1;
+}
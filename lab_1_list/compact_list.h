@@ -0,0 +1,618 @@
+#ifndef COMPACT_LIST_H_
+#define COMPACT_LIST_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/// Компактный список: узлы лежат в одном непрерывном растущем массиве и
+/// связаны 32-битными индексами вместо указателей. Ячейка 0 — единственный
+/// ограничитель (вместо пары отдельно выделенных _head/_tail в list).
+/// Освобождённые ячейки связываются в список свободных и переиспользуются.
+///
+/// Итераторы хранят индекс ячейки и остаются действительными при росте
+/// массива, пока их элемент не удалён; shrink_to_fit() перенумеровывает
+/// узлы и делает недействительными все итераторы. Итератор хранит указатель
+/// на сам список, поэтому после swap или перемещения итераторы старого
+/// списка недействительны.
+///
+/// Перемещённый список остаётся пустым и пригодным к использованию, но без
+/// массива (_nodes == nullptr): массив выделяется при первой вставке, так
+/// что перемещение не выделяет память и не бросает исключений.
+template <typename T>
+struct compact_list {
+ private:
+  struct list_node;
+  struct list_iterator;
+  struct reverse_list_iterator;
+
+ public:
+  using value_type = T;
+  using reference = value_type &;
+  using const_reference = value_type const &;
+  using iterator = list_iterator;
+  using reverse_iterator = reverse_list_iterator;
+  using size_type = std::size_t;
+  using index_type = std::uint32_t;
+
+  /// Конструктор
+  compact_list();
+  explicit compact_list(std::initializer_list<value_type> const &items);
+  /// Конструктор копирования
+  compact_list(compact_list const &l);
+  compact_list(compact_list &&l) noexcept;
+
+  /// Деструктор
+  ~compact_list();
+
+  compact_list &operator=(compact_list const &l);
+  compact_list &operator=(compact_list &&l) noexcept;
+
+  /// Опрос размера списка
+  size_type size() const noexcept;
+
+  /// Очистка списка. Память массива сохраняется
+  void clear() noexcept;
+
+  /// Проверка списка на пустоту
+  bool empty() const noexcept;
+
+  /// Опрос наличия заданного значения
+  bool contains(const_reference value);
+
+  /// Получение позиции в списке для заданного значения
+  size_type get_position(const_reference value);
+
+  /// Включение нового значения
+  void push_front(const_reference value);
+  void push_back(const_reference value);
+  template <typename... Args>
+  reference emplace_back(Args &&...args);
+  template <typename... Args>
+  reference emplace_front(Args &&...args);
+
+  // Включение нового значения перед заданной позицией
+  iterator insert(iterator pos, const_reference value);
+  template <typename... Args>
+  iterator emplace(iterator pos, Args &&...args);
+
+  //Удаление всех вхождений заданного значения из списка
+  void remove_value(const_reference value);
+
+  // Удаление значения в заданной позиции, возвращает итератор на следующее
+  iterator erase(iterator pos);
+
+  reference front();
+  const_reference front() const;
+  reference back();
+  const_reference back() const;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  void pop_back();
+  void pop_front();
+  void swap(compact_list &other) noexcept;
+
+  /// Резервирование ячеек под n элементов
+  void reserve(size_type n);
+  /// Число элементов, помещающихся без роста массива
+  size_type capacity() const noexcept;
+  /// Сжатие массива до размера списка с перенумерацией узлов в порядке
+  /// обхода: после неё обход идёт по памяти строго последовательно
+  void shrink_to_fit();
+
+  /// Объём памяти, занятый массивом узлов, в байтах
+  size_type memory_usage() const noexcept;
+
+ private:
+  static constexpr index_type _sentinel = 0;
+  static constexpr size_type _max_nodes =
+      std::numeric_limits<index_type>::max();
+
+  using _Node_alloc_type = std::allocator<list_node>;
+  using _List_node_manager = std::allocator_traits<_Node_alloc_type>;
+
+  _Node_alloc_type _a;
+  list_node *_nodes;
+  size_type _capacity;    // число ячеек массива, включая ограничитель
+  size_type _used;        // ячейки [0, _used) уже хоть раз выдавались
+  size_type _size;
+  index_type _free_head;  // 0 — свободных ячеек нет
+
+  void _init(size_type cells);
+  void _relocate(size_type cells, bool in_order);
+  void _destroy_all() noexcept;
+  index_type _take_slot();
+  void _link_before(index_type pos, index_type node) noexcept;
+
+  struct list_node {
+    index_type _prev;
+    index_type _next;
+    alignas(value_type) unsigned char _storage[sizeof(value_type)];
+
+    value_type *data() noexcept {
+      return std::launder(reinterpret_cast<value_type *>(_storage));
+    }
+  };
+
+  struct list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = compact_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+    using _Self = list_iterator;
+
+    compact_list *_list;
+    index_type _node;
+
+    list_iterator(compact_list *l, index_type node) noexcept
+        : _list(l), _node(node) {}
+
+    reference operator*() const noexcept {
+      return *_list->_nodes[_node].data();
+    }
+
+    _Self &operator++() noexcept {
+      _node = _list->_nodes[_node]._next;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _list->_nodes[_node]._prev;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+
+  struct reverse_list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = compact_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+    using _Self = reverse_list_iterator;
+
+    compact_list *_list;
+    index_type _node;
+
+    reverse_list_iterator(compact_list *l, index_type node) noexcept
+        : _list(l), _node(node) {}
+
+    reference operator*() const noexcept {
+      return *_list->_nodes[_node].data();
+    }
+
+    _Self &operator++() noexcept {
+      _node = _list->_nodes[_node]._prev;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _list->_nodes[_node]._next;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+};
+
+template <typename T>
+compact_list<T>::compact_list()
+    : _a(), _nodes(nullptr), _capacity(0), _used(0), _size(0), _free_head(0) {
+  _init(16);
+}
+
+template <typename T>
+compact_list<T>::compact_list(std::initializer_list<value_type> const &items)
+    : compact_list() {
+  reserve(items.size());
+  for (auto it = items.begin(); it != items.end(); ++it) {
+    push_back(*it);
+  }
+}
+
+template <typename T>
+compact_list<T>::compact_list(compact_list const &l) : compact_list() {
+  if (l._nodes == nullptr) return;
+
+  reserve(l._size);
+  for (index_type i = l._nodes[_sentinel]._next; i != _sentinel;
+       i = l._nodes[i]._next) {
+    push_back(*l._nodes[i].data());
+  }
+}
+
+template <typename T>
+compact_list<T>::compact_list(compact_list &&l) noexcept
+    : _a(),
+      _nodes(nullptr),
+      _capacity(0),
+      _used(0),
+      _size(0),
+      _free_head(0) {
+  swap(l);
+}
+
+template <typename T>
+compact_list<T>::~compact_list() {
+  if (_nodes == nullptr) return;
+
+  _destroy_all();
+  _List_node_manager::deallocate(_a, _nodes, _capacity);
+}
+
+template <typename T>
+compact_list<T> &compact_list<T>::operator=(compact_list const &l) {
+  if (this != &l) {
+    compact_list(l).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T>
+compact_list<T> &compact_list<T>::operator=(compact_list &&l) noexcept {
+  if (this != &l) {
+    compact_list(std::move(l)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T>
+void compact_list<T>::_init(size_type cells) {
+  _nodes = _List_node_manager::allocate(_a, cells);
+  _capacity = cells;
+  _used = 1;
+  _nodes[_sentinel]._prev = _sentinel;
+  _nodes[_sentinel]._next = _sentinel;
+}
+
+template <typename T>
+void compact_list<T>::_destroy_all() noexcept {
+  if (_nodes == nullptr) return;
+
+  if constexpr (!std::is_trivially_destructible_v<value_type>) {
+    for (index_type i = _nodes[_sentinel]._next; i != _sentinel;
+         i = _nodes[i]._next) {
+      _nodes[i].data()->~value_type();
+    }
+  }
+}
+
+// Перенос узлов в новый массив из cells ячеек. При in_order узлы
+// перенумеровываются в порядке обхода и свободные ячейки отбрасываются
+template <typename T>
+void compact_list<T>::_relocate(size_type cells, bool in_order) {
+  list_node *fresh = _List_node_manager::allocate(_a, cells);
+
+  if (in_order) {
+    index_type to = 1;
+    for (index_type i = _nodes[_sentinel]._next; i != _sentinel;
+         i = _nodes[i]._next, to++) {
+      ::new (static_cast<void *>(fresh[to]._storage))
+          value_type(std::move_if_noexcept(*_nodes[i].data()));
+      fresh[to]._prev = to - 1;
+      fresh[to]._next = to + 1;
+    }
+    index_type last = to - 1;
+    fresh[_sentinel]._next = _size ? 1 : _sentinel;
+    fresh[_sentinel]._prev = last;
+    fresh[last]._next = _sentinel;
+
+    _free_head = 0;
+    _used = _size + 1;
+  } else if constexpr (std::is_trivially_copyable_v<value_type>) {
+    std::memcpy(static_cast<void *>(fresh), _nodes, _used * sizeof(list_node));
+  } else {
+    // Связи копируются для всех ячеек (в том числе свободных), значения
+    // переносятся только для занятых
+    for (size_type i = 0; i < _used; i++) {
+      fresh[i]._prev = _nodes[i]._prev;
+      fresh[i]._next = _nodes[i]._next;
+    }
+    for (index_type i = _nodes[_sentinel]._next; i != _sentinel;
+         i = _nodes[i]._next) {
+      ::new (static_cast<void *>(fresh[i]._storage))
+          value_type(std::move_if_noexcept(*_nodes[i].data()));
+    }
+  }
+
+  _destroy_all();
+  _List_node_manager::deallocate(_a, _nodes, _capacity);
+  _nodes = fresh;
+  _capacity = cells;
+}
+
+template <typename T>
+typename compact_list<T>::index_type compact_list<T>::_take_slot() {
+  if (_free_head != 0) {
+    index_type slot = _free_head;
+    _free_head = _nodes[slot]._next;
+    return slot;
+  }
+
+  if (_nodes == nullptr) {
+    _init(16);
+  } else if (_used == _capacity) {
+    if (_capacity >= _max_nodes) throw std::length_error("compact_list");
+    _relocate(std::min(_capacity * 2, _max_nodes), false);
+  }
+  return static_cast<index_type>(_used++);
+}
+
+template <typename T>
+void compact_list<T>::_link_before(index_type pos, index_type node) noexcept {
+  index_type prev = _nodes[pos]._prev;
+  _nodes[node]._prev = prev;
+  _nodes[node]._next = pos;
+  _nodes[prev]._next = node;
+  _nodes[pos]._prev = node;
+}
+
+template <typename T>
+typename compact_list<T>::reference compact_list<T>::front() {
+  return *_nodes[_nodes[_sentinel]._next].data();
+}
+
+template <typename T>
+typename compact_list<T>::const_reference compact_list<T>::front() const {
+  return *_nodes[_nodes[_sentinel]._next].data();
+}
+
+template <typename T>
+typename compact_list<T>::reference compact_list<T>::back() {
+  return *_nodes[_nodes[_sentinel]._prev].data();
+}
+
+template <typename T>
+typename compact_list<T>::const_reference compact_list<T>::back() const {
+  return *_nodes[_nodes[_sentinel]._prev].data();
+}
+
+template <typename T>
+typename compact_list<T>::iterator compact_list<T>::begin() noexcept {
+  if (_nodes == nullptr) return end();
+  return list_iterator(this, _nodes[_sentinel]._next);
+}
+
+template <typename T>
+typename compact_list<T>::iterator compact_list<T>::end() noexcept {
+  return list_iterator(this, _sentinel);
+}
+
+template <typename T>
+typename compact_list<T>::reverse_iterator compact_list<T>::rbegin() noexcept {
+  if (_nodes == nullptr) return rend();
+  return reverse_list_iterator(this, _nodes[_sentinel]._prev);
+}
+
+template <typename T>
+typename compact_list<T>::reverse_iterator compact_list<T>::rend() noexcept {
+  return reverse_list_iterator(this, _sentinel);
+}
+
+template <typename T>
+bool compact_list<T>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T>
+typename compact_list<T>::size_type compact_list<T>::size() const noexcept {
+  return _size;
+}
+
+template <typename T>
+void compact_list<T>::clear() noexcept {
+  if (_nodes == nullptr) return;
+
+  _destroy_all();
+  _used = 1;
+  _size = 0;
+  _free_head = 0;
+  _nodes[_sentinel]._prev = _sentinel;
+  _nodes[_sentinel]._next = _sentinel;
+}
+
+template <typename T>
+typename compact_list<T>::iterator compact_list<T>::insert(
+    iterator pos, const_reference value) {
+  return emplace(pos, value);
+}
+
+template <typename T>
+template <typename... Args>
+typename compact_list<T>::iterator compact_list<T>::emplace(iterator pos,
+                                                            Args &&...args) {
+  // Значение создаётся до захвата ячейки: рост массива не должен сделать
+  // недействительными ссылки в args на элементы этого же списка
+  value_type value(std::forward<Args>(args)...);
+  index_type node = _take_slot();
+  ::new (static_cast<void *>(_nodes[node]._storage))
+      value_type(std::move(value));
+
+  _link_before(pos._node, node);
+  ++_size;
+
+  return list_iterator(this, node);
+}
+
+template <typename T>
+typename compact_list<T>::iterator compact_list<T>::erase(iterator pos) {
+  index_type node = pos._node;
+  if (node == _sentinel) return end();
+
+  index_type next = _nodes[node]._next;
+  _nodes[_nodes[node]._prev]._next = next;
+  _nodes[next]._prev = _nodes[node]._prev;
+
+  _nodes[node].data()->~value_type();
+  _nodes[node]._next = _free_head;
+  _free_head = node;
+  --_size;
+
+  return list_iterator(this, next);
+}
+
+template <typename T>
+void compact_list<T>::remove_value(const_reference value) {
+  // value может ссылаться на элемент списка: его узел удаляется последним,
+  // чтобы сравнения с value не читали освобождённую память
+  iterator held = end();
+  for (auto it = begin(); it != end();) {
+    if (*it == value) {
+      if (std::addressof(*it) == std::addressof(value)) {
+        held = it++;
+      } else {
+        it = erase(it);
+      }
+    } else {
+      ++it;
+    }
+  }
+  if (held != end()) erase(held);
+}
+
+template <typename T>
+void compact_list<T>::push_back(const_reference value) {
+  emplace(end(), value);
+}
+
+template <typename T>
+void compact_list<T>::push_front(const_reference value) {
+  emplace(begin(), value);
+}
+
+template <typename T>
+template <typename... Args>
+typename compact_list<T>::reference compact_list<T>::emplace_back(
+    Args &&...args) {
+  return *emplace(end(), std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename... Args>
+typename compact_list<T>::reference compact_list<T>::emplace_front(
+    Args &&...args) {
+  return *emplace(begin(), std::forward<Args>(args)...);
+}
+
+template <typename T>
+void compact_list<T>::pop_back() {
+  if (!empty()) {
+    erase(--end());
+  }
+}
+
+template <typename T>
+void compact_list<T>::pop_front() {
+  if (!empty()) {
+    erase(begin());
+  }
+}
+
+template <typename T>
+bool compact_list<T>::contains(const_reference value) {
+  for (auto it = begin(); it != end(); it++) {
+    if (*it == value) return true;
+  }
+  return false;
+}
+
+template <typename T>
+typename compact_list<T>::size_type compact_list<T>::get_position(
+    const_reference value) {
+  size_type count = 0;
+  for (auto it = begin(); it != end(); it++) {
+    if (*it == value) return count;
+    count++;
+  }
+  return -1;
+}
+
+template <typename T>
+void compact_list<T>::swap(compact_list &other) noexcept {
+  std::swap(_nodes, other._nodes);
+  std::swap(_capacity, other._capacity);
+  std::swap(_used, other._used);
+  std::swap(_size, other._size);
+  std::swap(_free_head, other._free_head);
+}
+
+template <typename T>
+void compact_list<T>::reserve(size_type n) {
+  if (n + 1 > _max_nodes) throw std::length_error("compact_list");
+  if (_nodes == nullptr) {
+    _init(std::max<size_type>(n + 1, 16));
+  } else if (n + 1 > _capacity) {
+    _relocate(n + 1, false);
+  }
+}
+
+template <typename T>
+typename compact_list<T>::size_type compact_list<T>::capacity()
+    const noexcept {
+  return _capacity ? _capacity - 1 : 0;
+}
+
+template <typename T>
+void compact_list<T>::shrink_to_fit() {
+  if (_nodes == nullptr) return;
+  _relocate(_size + 1, true);
+}
+
+template <typename T>
+typename compact_list<T>::size_type compact_list<T>::memory_usage()
+    const noexcept {
+  return _capacity * sizeof(list_node);
+}
+
+#endif  // COMPACT_LIST_H_
@@ -0,0 +1,336 @@
+#ifndef CONCURRENT_LIST_H_
+#define CONCURRENT_LIST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+#include "epoch.h"
+
+/// Список для многих читателей и редких писателей. Читатели обходят список
+/// без блокировок и без повторов: обход — только загрузки _next, поэтому
+/// каждый шаг завершается за конечное число действий независимо от других
+/// потоков. Писатели упорядочены внутренним мьютексом.
+///
+/// Писатель полностью создаёт узел и лишь затем публикует его одной
+/// атомарной записью _next предшественника. Исключённый узел сохраняет
+/// свой _next, так что читатель, стоящий на нём, продолжает обход, а сам
+/// узел удаляется через epoch_domain только после того, как все читатели,
+/// которые могли его видеть, вышли из своей эпохи.
+///
+/// Значения доступны только на чтение; изменить значение можно заменой
+/// узла (replace).
+template <typename T>
+struct concurrent_list {
+ private:
+  struct list_link;
+  struct list_node;
+  struct list_iterator;
+
+ public:
+  using value_type = T;
+  using const_reference = value_type const &;
+  using const_iterator = list_iterator;
+  using size_type = std::size_t;
+
+  /// Закреплённое представление для чтения. Пока оно живо, ни один узел,
+  /// достижимый через его итераторы, не будет освобождён
+  class view {
+   public:
+    const_iterator begin() const noexcept {
+      return list_iterator(_list->_head._next.load(std::memory_order_acquire));
+    }
+    const_iterator end() const noexcept { return list_iterator(nullptr); }
+
+   private:
+    friend struct concurrent_list;
+
+    explicit view(concurrent_list const &l)
+        : _list(&l), _guard(l._domain) {}
+
+    concurrent_list const *_list;
+    epoch_domain::guard _guard;
+  };
+
+  /// Конструктор
+  concurrent_list();
+  concurrent_list(concurrent_list const &) = delete;
+  concurrent_list &operator=(concurrent_list const &) = delete;
+
+  /// Деструктор. Список не должен использоваться другими потоками
+  ~concurrent_list();
+
+  /// Начало чтения
+  view read() const { return view(*this); }
+
+  /// Опрос размера списка (мгновенный снимок)
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+
+  /// Включение нового значения
+  void push_front(const_reference value);
+  void push_back(const_reference value);
+  template <typename... Args>
+  void emplace_back(Args &&...args);
+
+  /// Включение перед pos. pos получен из представления, закреплённого
+  /// вызывающим потоком; если элемент pos уже удалён, возвращает false
+  template <typename... Args>
+  bool emplace(const_iterator pos, Args &&...args);
+  bool insert(const_iterator pos, const_reference value);
+
+  /// Удаление элемента pos. false, если он уже удалён
+  bool erase(const_iterator pos);
+
+  /// Замена значения элемента pos новым узлом. Читатели видят либо старое,
+  /// либо новое значение целиком
+  bool replace(const_iterator pos, const_reference value);
+
+  /// Удаление всех элементов, удовлетворяющих условию, за один проход
+  template <typename Predicate>
+  size_type remove_if(Predicate pred);
+  size_type remove_value(const_reference value);
+
+  /// Очистка списка
+  void clear();
+
+ private:
+  // Ссылки на следующий узел читают все потоки, на предыдущий — только
+  // писатели под мьютексом
+  struct list_link {
+    std::atomic<list_link *> _next{nullptr};
+    list_link *_prev = nullptr;
+  };
+
+  struct list_node : list_link {
+    value_type _data;
+    bool _erased = false;
+
+    template <typename... Args>
+    explicit list_node(Args &&...args) : _data(std::forward<Args>(args)...) {}
+  };
+
+  struct list_iterator {
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = concurrent_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type const *;
+    using reference = value_type const &;
+    using _Self = list_iterator;
+
+    list_link *_node;
+
+    explicit list_iterator(list_link *node) noexcept : _node(node) {}
+
+    reference operator*() const noexcept {
+      return static_cast<list_node *>(_node)->_data;
+    }
+    pointer operator->() const noexcept {
+      return &static_cast<list_node *>(_node)->_data;
+    }
+
+    _Self &operator++() noexcept {
+      _node = _node->_next.load(std::memory_order_acquire);
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+
+  epoch_domain &_domain;
+  std::mutex _writer;
+  list_link _head;
+  list_link *_last;
+  std::atomic<size_type> _size;
+
+  void _link_before(list_link *pos, list_node *node) noexcept;
+  void _unlink(list_node *node) noexcept;
+};
+
+template <typename T>
+concurrent_list<T>::concurrent_list()
+    : _domain(epoch_domain::instance()), _last(&_head), _size(0) {}
+
+template <typename T>
+concurrent_list<T>::~concurrent_list() {
+  list_link *node = _head._next.load(std::memory_order_relaxed);
+  while (node != nullptr) {
+    list_link *next = node->_next.load(std::memory_order_relaxed);
+    delete static_cast<list_node *>(node);
+    node = next;
+  }
+}
+
+template <typename T>
+typename concurrent_list<T>::size_type concurrent_list<T>::size()
+    const noexcept {
+  return _size.load(std::memory_order_relaxed);
+}
+
+template <typename T>
+bool concurrent_list<T>::empty() const noexcept {
+  return _head._next.load(std::memory_order_acquire) == nullptr;
+}
+
+// Вставка перед pos (nullptr — в конец). Вызывается под мьютексом
+template <typename T>
+void concurrent_list<T>::_link_before(list_link *pos,
+                                      list_node *node) noexcept {
+  list_link *prev = pos != nullptr ? pos->_prev : _last;
+
+  node->_prev = prev;
+  node->_next.store(pos, std::memory_order_relaxed);
+  if (pos != nullptr) {
+    pos->_prev = node;
+  } else {
+    _last = node;
+  }
+
+  // Публикация: после этой записи читатели видят узел целиком
+  prev->_next.store(node, std::memory_order_release);
+  _size.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Исключение узла. Его _next не меняется, чтобы читатель, стоящий на узле,
+// мог продолжить обход. Вызывается под мьютексом
+template <typename T>
+void concurrent_list<T>::_unlink(list_node *node) noexcept {
+  list_link *prev = node->_prev;
+  list_link *next = node->_next.load(std::memory_order_relaxed);
+
+  prev->_next.store(next, std::memory_order_release);
+  if (next != nullptr) {
+    next->_prev = prev;
+  } else {
+    _last = prev;
+  }
+
+  node->_erased = true;
+  _size.fetch_sub(1, std::memory_order_relaxed);
+  _domain.retire(node);
+}
+
+template <typename T>
+void concurrent_list<T>::push_front(const_reference value) {
+  auto node = new list_node(value);
+  std::lock_guard<std::mutex> lock(_writer);
+  _link_before(_head._next.load(std::memory_order_relaxed), node);
+}
+
+template <typename T>
+void concurrent_list<T>::push_back(const_reference value) {
+  emplace_back(value);
+}
+
+template <typename T>
+template <typename... Args>
+void concurrent_list<T>::emplace_back(Args &&...args) {
+  auto node = new list_node(std::forward<Args>(args)...);
+  std::lock_guard<std::mutex> lock(_writer);
+  _link_before(nullptr, node);
+}
+
+template <typename T>
+template <typename... Args>
+bool concurrent_list<T>::emplace(const_iterator pos, Args &&...args) {
+  auto node = new list_node(std::forward<Args>(args)...);
+  std::lock_guard<std::mutex> lock(_writer);
+  if (pos._node != nullptr && static_cast<list_node *>(pos._node)->_erased) {
+    delete node;
+    return false;
+  }
+  _link_before(pos._node, node);
+  return true;
+}
+
+template <typename T>
+bool concurrent_list<T>::insert(const_iterator pos, const_reference value) {
+  return emplace(pos, value);
+}
+
+template <typename T>
+bool concurrent_list<T>::erase(const_iterator pos) {
+  if (pos._node == nullptr) return false;
+
+  auto node = static_cast<list_node *>(pos._node);
+  std::lock_guard<std::mutex> lock(_writer);
+  if (node->_erased) return false;
+
+  _unlink(node);
+  return true;
+}
+
+template <typename T>
+bool concurrent_list<T>::replace(const_iterator pos, const_reference value) {
+  if (pos._node == nullptr) return false;
+
+  auto fresh = new list_node(value);
+  auto old = static_cast<list_node *>(pos._node);
+  std::lock_guard<std::mutex> lock(_writer);
+  if (old->_erased) {
+    delete fresh;
+    return false;
+  }
+
+  // Новый узел публикуется на месте старого одной записью
+  list_link *next = old->_next.load(std::memory_order_relaxed);
+  fresh->_prev = old->_prev;
+  fresh->_next.store(next, std::memory_order_relaxed);
+  if (next != nullptr) {
+    next->_prev = fresh;
+  } else {
+    _last = fresh;
+  }
+  old->_prev->_next.store(fresh, std::memory_order_release);
+
+  old->_erased = true;
+  _domain.retire(old);
+  return true;
+}
+
+template <typename T>
+template <typename Predicate>
+typename concurrent_list<T>::size_type concurrent_list<T>::remove_if(
+    Predicate pred) {
+  auto g = _domain.pin();
+  std::lock_guard<std::mutex> lock(_writer);
+
+  size_type removed = 0;
+  list_link *node = _head._next.load(std::memory_order_relaxed);
+  while (node != nullptr) {
+    list_link *next = node->_next.load(std::memory_order_relaxed);
+    auto data_node = static_cast<list_node *>(node);
+    if (pred(static_cast<const_reference>(data_node->_data))) {
+      _unlink(data_node);
+      removed++;
+    }
+    node = next;
+  }
+  return removed;
+}
+
+template <typename T>
+typename concurrent_list<T>::size_type concurrent_list<T>::remove_value(
+    const_reference value) {
+  return remove_if([&value](const_reference item) { return item == value; });
+}
+
+template <typename T>
+void concurrent_list<T>::clear() {
+  remove_if([](const_reference) { return true; });
+}
+
+#endif  // CONCURRENT_LIST_H_
@@ -0,0 +1,223 @@
+#ifndef CONCURRENT_QUEUE_H_
+#define CONCURRENT_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "epoch.h"
+
+/// Неблокирующая очередь Майкла — Скотта для нескольких производителей и
+/// потребителей. Как и list, очередь держит ограничитель: голова всегда
+/// указывает на фиктивный узел, значения лежат в узлах за ним. Извлечённые
+/// узлы удаляются через epoch_domain, поэтому поток, который ещё читает
+/// узел, никогда не увидит освобождённую память.
+template <typename T>
+struct concurrent_queue {
+ private:
+  struct queue_node;
+
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+
+  /// Конструктор
+  concurrent_queue();
+  concurrent_queue(concurrent_queue const &) = delete;
+  concurrent_queue &operator=(concurrent_queue const &) = delete;
+
+  /// Деструктор. Очередь не должна использоваться другими потоками
+  ~concurrent_queue();
+
+  /// Включение значения в хвост очереди
+  void push(value_type const &value);
+  void push(value_type &&value);
+  template <typename... Args>
+  void emplace(Args &&...args);
+
+  /// Извлечение значения из головы очереди. false, если очередь пуста
+  bool try_pop(value_type &value);
+
+  /// Извлечение до n значений одним сдвигом головы. Возвращает число
+  /// извлечённых значений
+  template <typename OutputIt>
+  size_type try_pop_n(OutputIt out, size_type n);
+
+  /// Проверка очереди на пустоту (мгновенный снимок)
+  bool empty() const noexcept;
+
+ private:
+  struct queue_node {
+    std::atomic<queue_node *> _next{nullptr};
+    alignas(value_type) unsigned char _storage[sizeof(value_type)];
+
+    value_type *data() noexcept {
+      return std::launder(reinterpret_cast<value_type *>(_storage));
+    }
+  };
+
+  void _enqueue(queue_node *node);
+
+  epoch_domain &_domain;
+  alignas(64) std::atomic<queue_node *> _head;
+  alignas(64) std::atomic<queue_node *> _tail;
+};
+
+template <typename T>
+concurrent_queue<T>::concurrent_queue()
+    : _domain(epoch_domain::instance()) {
+  auto dummy = new queue_node;
+  _head.store(dummy, std::memory_order_relaxed);
+  _tail.store(dummy, std::memory_order_relaxed);
+}
+
+template <typename T>
+concurrent_queue<T>::~concurrent_queue() {
+  queue_node *node = _head.load(std::memory_order_relaxed);
+  queue_node *next = node->_next.load(std::memory_order_relaxed);
+  delete node;
+
+  // За фиктивным узлом все узлы хранят значения
+  for (node = next; node != nullptr; node = next) {
+    next = node->_next.load(std::memory_order_relaxed);
+    node->data()->~value_type();
+    delete node;
+  }
+}
+
+template <typename T>
+void concurrent_queue<T>::push(value_type const &value) {
+  emplace(value);
+}
+
+template <typename T>
+void concurrent_queue<T>::push(value_type &&value) {
+  emplace(std::move(value));
+}
+
+template <typename T>
+template <typename... Args>
+void concurrent_queue<T>::emplace(Args &&...args) {
+  auto node = new queue_node;
+  try {
+    ::new (static_cast<void *>(node->_storage))
+        value_type(std::forward<Args>(args)...);
+  } catch (...) {
+    delete node;
+    throw;
+  }
+  _enqueue(node);
+}
+
+template <typename T>
+void concurrent_queue<T>::_enqueue(queue_node *node) {
+  auto g = _domain.pin();
+
+  while (true) {
+    queue_node *tail = _tail.load(std::memory_order_acquire);
+    queue_node *next = tail->_next.load(std::memory_order_acquire);
+    if (tail != _tail.load(std::memory_order_acquire)) continue;
+
+    // Хвост отстал — помогаем его продвинуть
+    if (next != nullptr) {
+      _tail.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+
+    if (tail->_next.compare_exchange_weak(next, node,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+      _tail.compare_exchange_strong(tail, node, std::memory_order_release,
+                                    std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+
+template <typename T>
+bool concurrent_queue<T>::try_pop(value_type &value) {
+  auto g = _domain.pin();
+
+  while (true) {
+    queue_node *head = _head.load(std::memory_order_acquire);
+    queue_node *tail = _tail.load(std::memory_order_acquire);
+    queue_node *next = head->_next.load(std::memory_order_acquire);
+    if (head != _head.load(std::memory_order_acquire)) continue;
+
+    if (next == nullptr) return false;
+
+    if (head == tail) {
+      _tail.compare_exchange_weak(tail, next, std::memory_order_release,
+                                  std::memory_order_relaxed);
+      continue;
+    }
+
+    if (_head.compare_exchange_weak(head, next, std::memory_order_acq_rel,
+                                    std::memory_order_relaxed)) {
+      // next стал новым фиктивным узлом, значение забирает только этот поток
+      value = std::move(*next->data());
+      next->data()->~value_type();
+      _domain.retire(head);
+      return true;
+    }
+  }
+}
+
+template <typename T>
+template <typename OutputIt>
+typename concurrent_queue<T>::size_type concurrent_queue<T>::try_pop_n(
+    OutputIt out, size_type n) {
+  if (n == 0) return 0;
+
+  auto g = _domain.pin();
+
+  while (true) {
+    queue_node *head = _head.load(std::memory_order_acquire);
+    queue_node *tail = _tail.load(std::memory_order_acquire);
+
+    // Поиск последнего забираемого узла; хвост не должен остаться
+    // позади новой головы
+    queue_node *last = head;
+    size_type count = 0;
+    while (count < n) {
+      queue_node *next = last->_next.load(std::memory_order_acquire);
+      if (next == nullptr) break;
+      if (last == tail) {
+        _tail.compare_exchange_strong(tail, next, std::memory_order_release,
+                                      std::memory_order_relaxed);
+        tail = _tail.load(std::memory_order_acquire);
+      }
+      last = next;
+      count++;
+    }
+    if (count == 0) return 0;
+
+    if (_head.compare_exchange_strong(head, last, std::memory_order_acq_rel,
+                                      std::memory_order_relaxed)) {
+      queue_node *node = head;
+      for (size_type i = 0; i < count; i++) {
+        queue_node *next = node->_next.load(std::memory_order_acquire);
+        *out = std::move(*next->data());
+        ++out;
+        next->data()->~value_type();
+        _domain.retire(node);
+        node = next;
+      }
+      return count;
+    }
+  }
+}
+
+// Узлы не разыменовываются, поэтому закрепление в домене не нужно (pin()
+// может бросить исключение). Голова не обгоняет хвост: извлечение сначала
+// продвигает отставший хвост. Совпадение указателей значит, что очередь
+// пуста или вставка ещё не продвинула хвост и считается незавершённой
+template <typename T>
+bool concurrent_queue<T>::empty() const noexcept {
+  return _head.load(std::memory_order_acquire) ==
+         _tail.load(std::memory_order_acquire);
+}
+
+#endif  // CONCURRENT_QUEUE_H_
@@ -0,0 +1,188 @@
+#ifndef EPOCH_H_
+#define EPOCH_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+/// Освобождение памяти по эпохам для неблокирующих структур.
+///
+/// Поток, обращающийся к разделяемым узлам, «закрепляется» в текущей эпохе
+/// (pin). Узел, исключённый из структуры, не удаляется сразу, а
+/// откладывается (retire) с меткой эпохи. Глобальная эпоха продвигается,
+/// когда все закреплённые потоки дошли до неё; узел удаляется, когда эпоха
+/// ушла на два шага вперёд — к этому моменту ни один поток, который мог
+/// видеть узел, уже не закреплён.
+class epoch_domain {
+ public:
+  using size_type = std::size_t;
+
+  /// Наибольшее число одновременно работающих с доменом потоков
+  static constexpr size_type max_threads = 512;
+
+  /// Закрепление потока в эпохе на время жизни объекта. Вложенные
+  /// закрепления допустимы
+  class guard {
+   public:
+    explicit guard(epoch_domain &domain) : _domain(domain) { _domain.enter(); }
+    ~guard() { _domain.leave(); }
+
+    guard(guard const &) = delete;
+    guard &operator=(guard const &) = delete;
+
+   private:
+    epoch_domain &_domain;
+  };
+
+  /// Общий для всех структур домен
+  static epoch_domain &instance() {
+    static epoch_domain domain;
+    return domain;
+  }
+
+  guard pin() { return guard(*this); }
+
+  /// Отложенное удаление объекта, уже недостижимого из структуры
+  template <typename U>
+  void retire(U *p) {
+    retire(p, [](void *q) { delete static_cast<U *>(q); });
+  }
+
+  void retire(void *p, void (*deleter)(void *)) {
+    auto &ctx = local();
+    ctx._limbo.push_back({p, deleter, _epoch.load(std::memory_order_acquire)});
+    if (++ctx._since_collect >= collect_period) collect();
+  }
+
+  /// Попытка продвинуть эпоху и удалить отложенные объекты этого потока
+  void collect() {
+    auto &ctx = local();
+    ctx._since_collect = 0;
+
+    try_advance();
+    std::uint64_t epoch = _epoch.load(std::memory_order_acquire);
+    free_expired(ctx._limbo, epoch);
+
+    std::unique_lock<std::mutex> lock(_orphans_mutex, std::try_to_lock);
+    if (lock.owns_lock()) free_expired(_orphans, epoch);
+  }
+
+  ~epoch_domain() {
+    for (auto &r : _orphans) r._deleter(r._ptr);
+  }
+
+ private:
+  static constexpr size_type collect_period = 64;
+
+  struct retired {
+    void *_ptr;
+    void (*_deleter)(void *);
+    std::uint64_t _epoch;
+  };
+
+  // Состояние потока: 0 — не закреплён, иначе (эпоха << 1) | 1
+  struct alignas(64) thread_record {
+    std::atomic<std::uint64_t> _state{0};
+    std::atomic<bool> _in_use{false};
+  };
+
+  struct thread_context {
+    epoch_domain &_domain;
+    thread_record *_record;
+    size_type _nesting = 0;
+    size_type _since_collect = 0;
+    std::vector<retired> _limbo;
+
+    explicit thread_context(epoch_domain &domain)
+        : _domain(domain), _record(domain.acquire_record()) {}
+
+    ~thread_context() { _domain.detach(*this); }
+  };
+
+  epoch_domain() = default;
+
+  thread_context &local() {
+    thread_local thread_context ctx(*this);
+    return ctx;
+  }
+
+  void enter() {
+    auto &ctx = local();
+    if (ctx._nesting++ != 0) return;
+
+    std::uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+    ctx._record->_state.store((epoch << 1) | 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+
+  void leave() {
+    auto &ctx = local();
+    if (--ctx._nesting != 0) return;
+
+    ctx._record->_state.store(0, std::memory_order_release);
+  }
+
+  void try_advance() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+
+    size_type used = _records_used.load(std::memory_order_acquire);
+    for (size_type i = 0; i < used; i++) {
+      if (!_records[i]._in_use.load(std::memory_order_acquire)) continue;
+
+      std::uint64_t state = _records[i]._state.load(std::memory_order_acquire);
+      if ((state & 1) && (state >> 1) != epoch) return;
+    }
+    _epoch.compare_exchange_strong(epoch, epoch + 1,
+                                   std::memory_order_acq_rel);
+  }
+
+  // Объекты откладываются в порядке неубывания эпох — удаляется префикс
+  static void free_expired(std::vector<retired> &limbo, std::uint64_t epoch) {
+    size_type n = 0;
+    while (n < limbo.size() && limbo[n]._epoch + 2 <= epoch) {
+      limbo[n]._deleter(limbo[n]._ptr);
+      n++;
+    }
+    limbo.erase(limbo.begin(), limbo.begin() + static_cast<long>(n));
+  }
+
+  thread_record *acquire_record() {
+    for (size_type i = 0; i < max_threads; i++) {
+      bool expected = false;
+      if (_records[i]._in_use.compare_exchange_strong(
+              expected, true, std::memory_order_acq_rel)) {
+        size_type used = _records_used.load(std::memory_order_relaxed);
+        while (used < i + 1 && !_records_used.compare_exchange_weak(
+                                   used, i + 1, std::memory_order_release)) {
+        }
+        return &_records[i];
+      }
+    }
+    throw std::runtime_error("epoch_domain: too many threads");
+  }
+
+  // Завершение потока: его отложенные объекты передаются домену
+  void detach(thread_context &ctx) {
+    {
+      std::lock_guard<std::mutex> lock(_orphans_mutex);
+      _orphans.insert(_orphans.end(), ctx._limbo.begin(), ctx._limbo.end());
+    }
+    ctx._limbo.clear();
+
+    ctx._record->_state.store(0, std::memory_order_release);
+    ctx._record->_in_use.store(false, std::memory_order_release);
+  }
+
+  alignas(64) std::atomic<std::uint64_t> _epoch{2};
+  std::atomic<size_type> _records_used{0};
+  thread_record _records[max_threads];
+
+  std::mutex _orphans_mutex;
+  std::vector<retired> _orphans;
+};
+
+#endif  // EPOCH_H_
@@ -0,0 +1,436 @@
+#ifndef HASHED_LIST_H_
+#define HASHED_LIST_H_
+
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "list.h"
+
+/// Список с хеш-индексом значений. Рядом со списком хранится мультиотображение
+/// «хеш значения → узел», которое обновляется при каждой вставке и удалении,
+/// поэтому contains, count, find и remove_value выполняются за O(1) в среднем
+/// (remove_value — за O(k), где k — число удаляемых элементов).
+///
+/// Индекс строится по значению элемента, поэтому значения нельзя изменять
+/// через итераторы: итераторы и доступ к элементам только на чтение.
+template <typename T, typename Hash = std::hash<T>,
+          typename KeyEqual = std::equal_to<T>,
+          typename Alloc = std::allocator<T>>
+struct hashed_list {
+ private:
+  template <typename Base>
+  struct const_list_iterator;
+
+ public:
+  using list_type = list<T, Alloc>;
+  using value_type = T;
+  using reference = value_type const &;
+  using const_reference = value_type const &;
+  using iterator = const_list_iterator<typename list_type::iterator>;
+  using reverse_iterator =
+      const_list_iterator<typename list_type::reverse_iterator>;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+
+  /// Конструктор
+  hashed_list() = default;
+  explicit hashed_list(std::initializer_list<value_type> const &items);
+  /// Конструктор копирования
+  hashed_list(hashed_list const &l);
+  hashed_list(hashed_list &&l);
+
+  /// Присваивание копированием и перемещением
+  hashed_list &operator=(hashed_list const &l);
+  hashed_list &operator=(hashed_list &&l);
+
+  /// Опрос размера списка
+  size_type size() const noexcept;
+
+  /// Очистка списка
+  void clear();
+
+  /// Проверка списка на пустоту
+  bool empty() const noexcept;
+
+  /// Опрос наличия заданного значения. O(1) в среднем
+  bool contains(const_reference value) const;
+  /// Число элементов, равных заданному значению
+  size_type count(const_reference value) const;
+  /// Итератор на какой-либо элемент с заданным значением или end()
+  iterator find(const_reference value);
+
+  /// Чтение значения с заданным номером в списке. O(n)
+  const_reference at(size_type index);
+
+  /// Получение позиции в списке для заданного значения. Отсутствие значения
+  /// определяется за O(1), позиция найденного — обходом списка
+  size_type get_position(const_reference value);
+
+  /// Включение нового значения
+  void push_front(const_reference value);
+  void push_back(const_reference value);
+
+  // Включение нового значения перед заданной позицией
+  iterator insert(iterator pos, const_reference value);
+
+  //Удаление всех вхождений заданного значения из списка
+  void remove_value(const_reference value);
+
+  // Удаление значения из позиции с заданным номером
+  void erase(size_type ind);
+  void erase(iterator pos);
+
+  const_reference front() const;
+  const_reference back() const;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  void pop_back();
+  void pop_front();
+  void swap(hashed_list &other);
+
+  /// Оценка дополнительной памяти, занятой индексом, в байтах: корзины
+  /// хеш-таблицы и по одному узлу таблицы на элемент
+  size_type index_memory_usage() const noexcept;
+
+ private:
+  // Ключ индекса — уже посчитанный хеш значения
+  struct _identity_hash {
+    size_type operator()(size_type h) const noexcept { return h; }
+  };
+  using _List_iterator = typename list_type::iterator;
+  using _Index_type = std::unordered_multimap<size_type, _List_iterator,
+                                              _identity_hash>;
+
+  list_type _list;
+  _Index_type _index;
+  hasher _hash;
+  key_equal _eq;
+
+  void _index_insert(_List_iterator it);
+  void _index_erase(_List_iterator it);
+  void _reindex();
+
+  // Итератор списка, через который значение нельзя изменить: иначе
+  // индекс разошёлся бы со значениями
+  template <typename Base>
+  struct const_list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = hashed_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type const *;
+    using reference = value_type const &;
+    using _Self = const_list_iterator;
+
+    Base _base;
+
+    explicit const_list_iterator(Base base) noexcept : _base(base) {}
+
+    reference operator*() const noexcept { return *_base; }
+    pointer operator->() const noexcept { return std::addressof(*_base); }
+
+    _Self &operator++() noexcept {
+      ++_base;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      --_base;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _base == other._base;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _base != other._base;
+    }
+  };
+};
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+hashed_list<T, Hash, KeyEqual, Alloc>::hashed_list(
+    std::initializer_list<value_type> const &items)
+    : _list(items) {
+  _reindex();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+hashed_list<T, Hash, KeyEqual, Alloc>::hashed_list(hashed_list const &l)
+    : _list(l._list), _hash(l._hash), _eq(l._eq) {
+  _reindex();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+hashed_list<T, Hash, KeyEqual, Alloc>::hashed_list(hashed_list &&l)
+    : _list(std::move(l._list)),
+      _index(std::move(l._index)),
+      _hash(l._hash),
+      _eq(l._eq) {
+  l._index.clear();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+hashed_list<T, Hash, KeyEqual, Alloc> &
+hashed_list<T, Hash, KeyEqual, Alloc>::operator=(hashed_list const &l) {
+  if (this != &l) {
+    hashed_list(l).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+hashed_list<T, Hash, KeyEqual, Alloc> &
+hashed_list<T, Hash, KeyEqual, Alloc>::operator=(hashed_list &&l) {
+  if (this != &l) {
+    hashed_list(std::move(l)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::_index_insert(
+    _List_iterator it) {
+  _index.emplace(_hash(*it), it);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::_index_erase(
+    _List_iterator it) {
+  auto range = _index.equal_range(_hash(*it));
+  for (auto r = range.first; r != range.second; ++r) {
+    if (r->second == it) {
+      _index.erase(r);
+      return;
+    }
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::_reindex() {
+  _index.clear();
+  _index.reserve(_list.size());
+  for (auto it = _list.begin(); it != _list.end(); ++it) _index_insert(it);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::size_type
+hashed_list<T, Hash, KeyEqual, Alloc>::size() const noexcept {
+  return _list.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::clear() {
+  _index.clear();
+  _list.clear();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool hashed_list<T, Hash, KeyEqual, Alloc>::empty() const noexcept {
+  return _list.empty();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool hashed_list<T, Hash, KeyEqual, Alloc>::contains(
+    const_reference value) const {
+  auto range = _index.equal_range(_hash(value));
+  for (auto r = range.first; r != range.second; ++r) {
+    if (_eq(*r->second, value)) return true;
+  }
+  return false;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::size_type
+hashed_list<T, Hash, KeyEqual, Alloc>::count(const_reference value) const {
+  size_type n = 0;
+  auto range = _index.equal_range(_hash(value));
+  for (auto r = range.first; r != range.second; ++r) {
+    if (_eq(*r->second, value)) n++;
+  }
+  return n;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::find(const_reference value) {
+  auto range = _index.equal_range(_hash(value));
+  for (auto r = range.first; r != range.second; ++r) {
+    if (_eq(*r->second, value)) return iterator(r->second);
+  }
+  return end();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::const_reference
+hashed_list<T, Hash, KeyEqual, Alloc>::at(size_type index) {
+  return _list.at(index);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::size_type
+hashed_list<T, Hash, KeyEqual, Alloc>::get_position(const_reference value) {
+  if (!contains(value)) return -1;
+
+  size_type count = 0;
+  for (auto it = begin(); it != end(); it++) {
+    if (_eq(*it, value)) return count;
+    count++;
+  }
+  return -1;
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::push_front(
+    const_reference value) {
+  insert(begin(), value);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::push_back(const_reference value) {
+  insert(end(), value);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::insert(iterator pos,
+                                              const_reference value) {
+  auto it = _list.insert(pos._base, value);
+  try {
+    _index_insert(it);
+  } catch (...) {
+    _list.erase(it);
+    throw;
+  }
+  return iterator(it);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::remove_value(
+    const_reference value) {
+  // value может ссылаться на элемент самого списка: его узел удаляется
+  // последним, чтобы сравнения с value не читали освобождённую память
+  _List_iterator held = _list.end();
+  auto range = _index.equal_range(_hash(value));
+  for (auto r = range.first; r != range.second;) {
+    if (_eq(*r->second, value)) {
+      if (std::addressof(*r->second) == std::addressof(value)) {
+        held = r->second;
+      } else {
+        _list.erase(r->second);
+      }
+      r = _index.erase(r);
+    } else {
+      ++r;
+    }
+  }
+  if (held != _list.end()) _list.erase(held);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::erase(size_type ind) {
+  auto it = begin();
+  for (size_type i = 0; i < ind; i++) {
+    it++;
+  }
+  erase(it);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::erase(iterator pos) {
+  if (pos == end()) return;
+
+  _index_erase(pos._base);
+  _list.erase(pos._base);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::const_reference
+hashed_list<T, Hash, KeyEqual, Alloc>::front() const {
+  return _list.front();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::const_reference
+hashed_list<T, Hash, KeyEqual, Alloc>::back() const {
+  return _list.back();
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::begin() noexcept {
+  return iterator(_list.begin());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::end() noexcept {
+  return iterator(_list.end());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::reverse_iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::rbegin() noexcept {
+  return reverse_iterator(_list.rbegin());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::reverse_iterator
+hashed_list<T, Hash, KeyEqual, Alloc>::rend() noexcept {
+  return reverse_iterator(_list.rend());
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::pop_back() {
+  if (!empty()) {
+    erase(--end());
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::pop_front() {
+  if (!empty()) {
+    erase(begin());
+  }
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+void hashed_list<T, Hash, KeyEqual, Alloc>::swap(hashed_list &other) {
+  _list.swap(other._list);
+  _index.swap(other._index);
+  std::swap(_hash, other._hash);
+  std::swap(_eq, other._eq);
+}
+
+template <typename T, typename Hash, typename KeyEqual, typename Alloc>
+typename hashed_list<T, Hash, KeyEqual, Alloc>::size_type
+hashed_list<T, Hash, KeyEqual, Alloc>::index_memory_usage() const noexcept {
+  // Узел хеш-таблицы: указатель на следующий узел и пара «хеш, итератор»
+  size_type node_size =
+      sizeof(void *) + sizeof(typename _Index_type::value_type);
+  return _index.bucket_count() * sizeof(void *) + _index.size() * node_size;
+}
+
+#endif  // HASHED_LIST_H_
@@ -0,0 +1,436 @@
+#ifndef INTRUSIVE_LIST_H_
+#define INTRUSIVE_LIST_H_
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+/// Крючок для встраивания объекта в intrusive_list. Связывание то же, что у
+/// узла list: пара указателей _prev/_next, отвязанный крючок указывает сам
+/// на себя. Объект с несколькими крючками может одновременно состоять в
+/// нескольких списках.
+///
+/// Как и узел list, крючок при разрушении сам исключает себя из списка.
+/// Копия объекта в список не входит.
+struct list_hook {
+  list_hook *_prev;
+  list_hook *_next;
+
+  list_hook() noexcept : _prev(this), _next(this) {}
+  list_hook(list_hook const &) noexcept : list_hook() {}
+  list_hook &operator=(list_hook const &) noexcept { return *this; }
+
+  ~list_hook() noexcept { unlink(); }
+
+  /// Входит ли объект в какой-либо список через этот крючок
+  bool is_linked() const noexcept { return _next != this; }
+
+  /// Исключение из списка за O(1)
+  void unlink() noexcept {
+    _prev->_next = _next;
+    _next->_prev = _prev;
+    _prev = _next = this;
+  }
+};
+
+/// Интрузивный список: узлами служат крючки внутри самих объектов, поэтому
+/// вставка и удаление только перецепляют указатели и ничего не выделяют.
+/// Список не владеет объектами и не копирует их.
+///
+/// Объекты исключаются из списка автоматически при разрушении, поэтому
+/// size() считается обходом за O(n); empty() — O(1).
+template <typename T, list_hook T::*Hook>
+struct intrusive_list {
+ private:
+  struct list_iterator;
+  struct reverse_list_iterator;
+
+ public:
+  using value_type = T;
+  using reference = value_type &;
+  using const_reference = value_type const &;
+  using iterator = list_iterator;
+  using reverse_iterator = reverse_list_iterator;
+  using size_type = std::size_t;
+
+  /// Конструктор
+  intrusive_list() noexcept;
+  intrusive_list(intrusive_list const &) = delete;
+  intrusive_list(intrusive_list &&l) noexcept;
+
+  /// Деструктор. Объекты не разрушаются, а только исключаются из списка
+  ~intrusive_list();
+
+  intrusive_list &operator=(intrusive_list const &) = delete;
+  intrusive_list &operator=(intrusive_list &&l) noexcept;
+
+  /// Опрос размера списка. O(n)
+  size_type size() const noexcept;
+
+  /// Исключение всех объектов из списка
+  void clear() noexcept;
+
+  /// Проверка списка на пустоту
+  bool empty() const noexcept;
+
+  /// Включение объекта. Если объект уже состоит в списке через этот
+  /// крючок, он переносится
+  void push_front(reference value) noexcept;
+  void push_back(reference value) noexcept;
+  iterator insert(iterator pos, reference value) noexcept;
+
+  /// Исключение объекта, возвращает итератор на следующий. O(1)
+  iterator erase(iterator pos) noexcept;
+  iterator erase(reference value) noexcept;
+
+  /// Итератор на объект, состоящий в списке. O(1)
+  iterator iterator_to(reference value) noexcept;
+
+  /// Перенос всех объектов другого списка перед pos. O(1)
+  void splice(iterator pos, intrusive_list &other) noexcept;
+
+  reference front() noexcept;
+  const_reference front() const noexcept;
+  reference back() noexcept;
+  const_reference back() const noexcept;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  void pop_back() noexcept;
+  void pop_front() noexcept;
+  void swap(intrusive_list &other) noexcept;
+
+ private:
+  // Ограничители встроены в сам список
+  list_hook _head;
+  list_hook _tail;
+
+  static list_hook *_hook_of(reference value) noexcept {
+    return &(value.*Hook);
+  }
+
+  // Смещение крючка внутри объекта. Оно одинаково у всех объектов T и
+  // запоминается при включении объекта в список; до первого включения ни
+  // один крючок не ведёт к объекту, и _value_of не вызывается
+  static inline std::atomic<std::ptrdiff_t> _hook_offset{0};
+
+  static void _remember_offset(reference value) noexcept {
+    std::ptrdiff_t offset =
+        reinterpret_cast<unsigned char *>(_hook_of(value)) -
+        reinterpret_cast<unsigned char *>(std::addressof(value));
+    if (_hook_offset.load(std::memory_order_relaxed) != offset) {
+      _hook_offset.store(offset, std::memory_order_relaxed);
+    }
+  }
+
+  static reference _value_of(list_hook *hook) noexcept {
+    return *reinterpret_cast<T *>(
+        reinterpret_cast<unsigned char *>(hook) -
+        _hook_offset.load(std::memory_order_relaxed));
+  }
+
+  void _reset() noexcept;
+  void _adopt(intrusive_list &other) noexcept;
+
+  struct list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = intrusive_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+    using _Self = list_iterator;
+
+    list_hook *_node;
+
+    explicit list_iterator(list_hook *node) noexcept : _node(node) {}
+
+    reference operator*() const noexcept { return _value_of(_node); }
+    pointer operator->() const noexcept { return &_value_of(_node); }
+
+    _Self &operator++() noexcept {
+      _node = _node->_next;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _node->_prev;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+
+  struct reverse_list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = intrusive_list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
+    using _Self = reverse_list_iterator;
+
+    list_hook *_node;
+
+    explicit reverse_list_iterator(list_hook *node) noexcept : _node(node) {}
+
+    reference operator*() const noexcept { return _value_of(_node); }
+    pointer operator->() const noexcept { return &_value_of(_node); }
+
+    _Self &operator++() noexcept {
+      _node = _node->_prev;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _node->_next;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+};
+
+template <typename T, list_hook T::*Hook>
+intrusive_list<T, Hook>::intrusive_list() noexcept {
+  _reset();
+}
+
+template <typename T, list_hook T::*Hook>
+intrusive_list<T, Hook>::intrusive_list(intrusive_list &&l) noexcept {
+  _reset();
+  _adopt(l);
+}
+
+template <typename T, list_hook T::*Hook>
+intrusive_list<T, Hook>::~intrusive_list() {
+  clear();
+  // Ограничители отвязываются друг от друга до своего разрушения
+  _head._prev = _head._next = &_head;
+  _tail._prev = _tail._next = &_tail;
+}
+
+template <typename T, list_hook T::*Hook>
+intrusive_list<T, Hook> &intrusive_list<T, Hook>::operator=(
+    intrusive_list &&l) noexcept {
+  if (this != &l) {
+    clear();
+    _adopt(l);
+  }
+  return *this;
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::_reset() noexcept {
+  _head._next = &_tail;
+  _head._prev = &_head;
+  _tail._next = &_tail;
+  _tail._prev = &_head;
+}
+
+// Перенос всех объектов из other в пустой список
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::_adopt(intrusive_list &other) noexcept {
+  if (other.empty()) return;
+
+  _head._next = other._head._next;
+  _tail._prev = other._tail._prev;
+  _head._next->_prev = &_head;
+  _tail._prev->_next = &_tail;
+
+  other._reset();
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::size_type intrusive_list<T, Hook>::size()
+    const noexcept {
+  size_type count = 0;
+  for (auto node = _head._next; node != &_tail; node = node->_next) count++;
+  return count;
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::clear() noexcept {
+  while (!empty()) _head._next->unlink();
+}
+
+template <typename T, list_hook T::*Hook>
+bool intrusive_list<T, Hook>::empty() const noexcept {
+  return _head._next == &_tail;
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::push_front(reference value) noexcept {
+  insert(begin(), value);
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::push_back(reference value) noexcept {
+  insert(end(), value);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator intrusive_list<T, Hook>::insert(
+    iterator pos, reference value) noexcept {
+  list_hook *node = _hook_of(value);
+  if (node == pos._node) return pos;
+  if (node->is_linked()) node->unlink();
+  _remember_offset(value);
+
+  list_hook *prev = pos._node->_prev;
+  node->_prev = prev;
+  node->_next = pos._node;
+  prev->_next = node;
+  pos._node->_prev = node;
+
+  return list_iterator(node);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator intrusive_list<T, Hook>::erase(
+    iterator pos) noexcept {
+  if (pos._node == &_tail || pos._node == &_head) return end();
+
+  auto next = pos._node->_next;
+  pos._node->unlink();
+  return list_iterator(next);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator intrusive_list<T, Hook>::erase(
+    reference value) noexcept {
+  return erase(iterator_to(value));
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::iterator_to(reference value) noexcept {
+  return list_iterator(_hook_of(value));
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::splice(iterator pos,
+                                     intrusive_list &other) noexcept {
+  if (this == &other || other.empty()) return;
+
+  list_hook *first = other._head._next;
+  list_hook *last = other._tail._prev;
+  other._reset();
+
+  list_hook *prev = pos._node->_prev;
+  first->_prev = prev;
+  last->_next = pos._node;
+  prev->_next = first;
+  pos._node->_prev = last;
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::reference
+intrusive_list<T, Hook>::front() noexcept {
+  return _value_of(_head._next);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::const_reference
+intrusive_list<T, Hook>::front() const noexcept {
+  return _value_of(_head._next);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::reference
+intrusive_list<T, Hook>::back() noexcept {
+  return _value_of(_tail._prev);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::const_reference
+intrusive_list<T, Hook>::back() const noexcept {
+  return _value_of(_tail._prev);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::begin() noexcept {
+  return list_iterator(_head._next);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::iterator
+intrusive_list<T, Hook>::end() noexcept {
+  return list_iterator(&_tail);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::reverse_iterator
+intrusive_list<T, Hook>::rbegin() noexcept {
+  return reverse_list_iterator(_tail._prev);
+}
+
+template <typename T, list_hook T::*Hook>
+typename intrusive_list<T, Hook>::reverse_iterator
+intrusive_list<T, Hook>::rend() noexcept {
+  return reverse_list_iterator(&_head);
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::pop_back() noexcept {
+  if (!empty()) {
+    _tail._prev->unlink();
+  }
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::pop_front() noexcept {
+  if (!empty()) {
+    _head._next->unlink();
+  }
+}
+
+template <typename T, list_hook T::*Hook>
+void intrusive_list<T, Hook>::swap(intrusive_list &other) noexcept {
+  intrusive_list tmp(std::move(other));
+  other._adopt(*this);
+  _adopt(tmp);
+}
+
+#endif  // INTRUSIVE_LIST_H_
@@ -1,16 +1,28 @@
 #ifndef LIST_H_
 #define LIST_H_
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
-template <typename T>
+template <typename T, typename Alloc = std::allocator<T>>
 struct list {
  private:
   struct list_node;
   struct list_iterator;
   struct reverse_list_iterator;
 
+  template <typename InputIt>
+  using _Require_input_iter = std::enable_if_t<std::is_convertible_v<
+      typename std::iterator_traits<InputIt>::iterator_category,
+      std::input_iterator_tag>>;
+
  public:
   using value_type = T;
   using reference = value_type &;
@@ -18,11 +30,18 @@ struct list {
   using iterator = list_iterator;
   using reverse_iterator = reverse_list_iterator;
   using size_type = std::size_t;
+  using allocator_type = Alloc;
 
   /// Конструктор
   list();
+  explicit list(allocator_type const &a);
   explicit list(size_type n);
+  list(size_type n, const_reference value);
   explicit list(std::initializer_list<value_type> const &items);
+  /// Конструктор из диапазона. Узлы собираются в отдельную цепочку и
+  /// подцепляются к списку одним переносом
+  template <typename InputIt, typename = _Require_input_iter<InputIt>>
+  list(InputIt first, InputIt last);
   /// Конструктор копирования
   list(list const &l);
   list(list &&l);
@@ -30,7 +49,9 @@ struct list {
   /// Деструктор
   ~list();
 
-  //   list &operator=(list &&l);
+  /// Присваивание копированием и перемещением
+  list &operator=(list const &l);
+  list &operator=(list &&l);
 
   /// Опрос размера списка
   size_type size() const noexcept;
@@ -53,21 +74,49 @@ struct list {
 
   /// Включение нового значения
   void push_front(const_reference value);
+  void push_front(value_type &&value);
   void push_back(const_reference value);
+  void push_back(value_type &&value);
+  /// Создание нового значения на месте из аргументов конструктора
   template <typename... Args>
-  void emplace_back(Args &&...args);
+  reference emplace_back(Args &&...args);
   template <typename... Args>
-  void emplace_front(Args &&...args);
+  reference emplace_front(Args &&...args);
 
   // Включение нового значения в позицию с заданным номером
   iterator insert(iterator pos, const_reference value);
+  iterator insert(iterator pos, value_type &&value);
+  // Включение диапазона значений перед pos, возвращает итератор на первое
+  // включённое значение
+  template <typename InputIt, typename = _Require_input_iter<InputIt>>
+  iterator insert(iterator pos, InputIt first, InputIt last);
+  iterator insert(iterator pos, std::initializer_list<value_type> items);
+  iterator insert(iterator pos, size_type n, const_reference value);
+
+  /// Замена содержимого списка. Существующие узлы переиспользуются
+  void assign(size_type n, const_reference value);
+  template <typename InputIt, typename = _Require_input_iter<InputIt>>
+  void assign(InputIt first, InputIt last);
+  void assign(std::initializer_list<value_type> items);
   template <typename... Args>
   iterator emplace(size_type pos, Args &&...args);
   template <typename... Args>
   iterator emplace(iterator pos, Args &&...args);
 
-  //Удаление заданного значения из списка
-  void remove_value(const_reference value);
+  /// Удаление всех вхождений заданного значения за один проход. Узлы
+  /// отцепляются в цепочку и освобождаются разом в конце, поэтому value
+  /// может ссылаться на элемент самого списка. Возвращает число удалённых
+  size_type remove_value(const_reference value);
+  template <typename Predicate>
+  size_type remove_if(Predicate pred);
+
+  /// remove_if с параллельным вычислением предиката: список делится на
+  /// threads участков, предикат вызывается из нескольких потоков сразу и
+  /// не должен менять общее состояние и бросать исключений. Отцепление
+  /// узлов однопоточное. Небольшие списки обрабатываются обычным remove_if()
+  template <typename Predicate>
+  size_type parallel_remove_if(
+      Predicate pred, size_type threads = std::thread::hardware_concurrency());
 
   // Удаление значения из позиции с заданным номером
   void erase(size_type ind);
@@ -94,25 +143,110 @@ struct list {
   void pop_front();
   void swap(list &other);
 
+  /// Перенос элементов другого списка перед pos без копирования: узлы
+  /// перецепляются за O(1). Если аллокаторы списков не равны, элементы
+  /// перемещаются в новые узлы этого списка
+  void splice(iterator pos, list &other);
+  void splice(iterator pos, list &other, iterator it);
+  /// Перенос диапазона [first, last). Длина диапазона считается обходом,
+  /// если она известна заранее, её можно передать в n — тогда перенос O(1)
+  void splice(iterator pos, list &other, iterator first, iterator last);
+  void splice(iterator pos, list &other, iterator first, iterator last,
+              size_type n);
+
+  /// Слияние с другим упорядоченным списком перецеплением узлов
+  void merge(list &other);
+  template <typename Compare>
+  void merge(list &other, Compare comp);
+
+  /// Устойчивая сортировка слиянием снизу вверх. Узлы перецепляются,
+  /// дополнительная память не выделяется. Сравнение не должно бросать
+  /// исключений
+  void sort();
+  template <typename Compare>
+  void sort(Compare comp);
+
+  /// Параллельная сортировка: список режется на threads подсписков, они
+  /// сортируются в отдельных потоках и затем попарно сливаются. Небольшие
+  /// списки сортируются обычным sort()
+  template <typename Compare = std::less<value_type>>
+  void parallel_sort(Compare comp = Compare(),
+                     size_type threads = std::thread::hardware_concurrency());
+
+  /// Удаление подряд идущих повторяющихся значений
+  void unique();
+  template <typename BinaryPredicate>
+  void unique(BinaryPredicate pred);
+
+  allocator_type get_allocator() const;
+
  private:
+  using _Node_alloc_type = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<list_node>;
+  using _List_node_manager = std::allocator_traits<_Node_alloc_type>;
+
+  // Аллокатор объявлен первым: он нужен при создании ограничителей
+  _Node_alloc_type _a;
   size_type _size;
   list_node *_head;
   list_node *_tail;
 
-  std::allocator<list_node> _a;
-  using _List_node_manager = std::allocator_traits<std::allocator<list_node>>;
-
   void insert(iterator _pos, list_node *_node = nullptr) noexcept;
 
+  void _create_sentinels();
+  bool _release_nodes() noexcept;
+
+  // Массовое создание узлов: цепочка собирается вне списка и вставляется
+  // перед pos одной правкой указателей
+  void _reserve_nodes(size_type n);
+  template <typename InputIt>
+  iterator _insert_range(iterator pos, InputIt first, InputIt last);
+  template <typename... Args>
+  iterator _insert_n(iterator pos, size_type n, Args const &...args);
+  template <typename... Args>
+  list_node *_make_node(Args &&...args);
+  iterator _link_chain(iterator pos, list_node *first, list_node *last,
+                       size_type n) noexcept;
+  void _free_chain(list_node *first) noexcept;
+
+  // Операции над цепочками узлов, связанными только через _next и
+  // оканчивающимися nullptr. Используются сортировкой и слиянием
+  bool _can_relink(list const &other) const noexcept;
+  static void _transfer(list_node *pos, list_node *first,
+                        list_node *last) noexcept;
+  list_node *_cut_chain() noexcept;
+  void _attach_chain(list_node *first) noexcept;
+  template <typename Compare>
+  static list_node *_merge_chains(list_node *a, list_node *b, Compare &comp);
+  template <typename Compare>
+  static list_node *_sort_chain(list_node *first, Compare &comp);
+
+  // Однопроходное удаление узлов, для которых doomed(node) истинно.
+  // Отцеплённые узлы собираются в цепочку и освобождаются пачками по
+  // _release_batch, пока они ещё в кеше; узел со значением *alias
+  // освобождается последним
+  template <typename Doomed>
+  size_type _remove_nodes(Doomed doomed, value_type const *alias);
+
+  // Запуск job(0) ... job(count - 1) в отдельных потоках
+  template <typename Job>
+  static void _run_parallel(Job &&job, size_type count);
+
+  // Списки короче порога parallel_sort сортирует в одном потоке
+  static constexpr size_type _parallel_sort_threshold = 1 << 15;
+  // То же для parallel_remove_if
+  static constexpr size_type _parallel_remove_threshold = 1 << 14;
+  static constexpr size_type _release_batch = 16;
+
   struct list_node {
     list_node *_prev;
     list_node *_next;
-    value_type _data = {};
-
-    list_node() noexcept : _prev(this), _next(this) {}
+    value_type _data;
 
-    explicit list_node(const_reference data)
-        : _prev(this), _next(this), _data(data) {}
+    // Значение создаётся сразу из аргументов, без промежуточной копии
+    template <typename... Args>
+    explicit list_node(Args &&...args)
+        : _prev(this), _next(this), _data(std::forward<Args>(args)...) {}
 
     ~list_node() noexcept {
       _prev->_next = _next;
@@ -121,6 +255,11 @@ struct list {
   };
 
   struct list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
     using _Self = list_iterator;
 
     list_node *_node;
@@ -161,6 +300,11 @@ struct list {
   };
 
   struct reverse_list_iterator {
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = list::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type *;
+    using reference = value_type &;
     using _Self = reverse_list_iterator;
 
     list_node *_node;
@@ -201,136 +345,358 @@ struct list {
   };
 };
 
-template <typename T>
-list<T>::list()
-    : _size(0),
-      _head(_List_node_manager::allocate(_a, 1)),
-      _tail(_List_node_manager::allocate(_a, 1)) {
+template <typename T, typename Alloc>
+list<T, Alloc>::list() : list(allocator_type()) {}
+
+template <typename T, typename Alloc>
+list<T, Alloc>::list(allocator_type const &a)
+    : _a(a), _size(0), _head(nullptr), _tail(nullptr) {
+  _create_sentinels();
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::_create_sentinels() {
+  _head = _List_node_manager::allocate(_a, 1);
+  _tail = _List_node_manager::allocate(_a, 1);
+
   _head->_next = _tail;
   _head->_prev = _head;
   _tail->_next = _tail;
   _tail->_prev = _head;
 }
 
-template <typename T>
-list<T>::list(size_type n) : list() {
-  while (n--) {
-    auto node = _List_node_manager::allocate(_a, 1);
-    _List_node_manager::construct(_a, node);
-
-    insert(end(), node);
+// Если аллокатор умеет освобождать весь пул разом (slab_allocator), а
+// элементы не требуют вызова деструктора, узлы не обходятся по одному
+template <typename A, typename = void>
+struct _has_release : std::false_type {};
+
+template <typename A>
+struct _has_release<A, std::void_t<decltype(std::declval<A &>().release())>>
+    : std::true_type {};
+
+template <typename T, typename Alloc>
+bool list<T, Alloc>::_release_nodes() noexcept {
+  if constexpr (std::is_trivially_destructible_v<value_type> &&
+                _has_release<_Node_alloc_type>::value) {
+    if (_a.release()) {
+      _head = _tail = nullptr;
+      _size = 0;
+      return true;
+    }
   }
+  return false;
 }
 
-template <typename T>
-list<T>::list(std::initializer_list<value_type> const &items) : list() {
-  for (auto it = items.begin(); it != items.end(); ++it) {
-    push_back(*it);
-  }
+template <typename T, typename Alloc>
+list<T, Alloc>::list(size_type n) : list() {
+  _insert_n(end(), n);
 }
 
-template <typename T>
-list<T>::list(list const &l) : list() {
-  for (auto it = l.begin(); it != l.end(); ++it) {
-    push_back(*it);
-  }
+template <typename T, typename Alloc>
+list<T, Alloc>::list(size_type n, const_reference value) : list() {
+  _insert_n(end(), n, value);
+}
+
+template <typename T, typename Alloc>
+list<T, Alloc>::list(std::initializer_list<value_type> const &items)
+    : list() {
+  _insert_range(end(), items.begin(), items.end());
+}
+
+template <typename T, typename Alloc>
+template <typename InputIt, typename>
+list<T, Alloc>::list(InputIt first, InputIt last) : list() {
+  _insert_range(end(), first, last);
 }
 
-template <typename T>
-list<T>::list(list &&l) : list() {
+template <typename T, typename Alloc>
+list<T, Alloc>::list(list const &l)
+    : list(allocator_type(
+          _List_node_manager::select_on_container_copy_construction(l._a))) {
+  _reserve_nodes(l._size);
+  _insert_range(end(), list_iterator(l._head->_next), list_iterator(l._tail));
+}
+
+template <typename T, typename Alloc>
+list<T, Alloc>::list(list &&l) : list() {
   swap(l);
 }
 
-template <typename T>
-list<T>::~list() {
+template <typename T, typename Alloc>
+list<T, Alloc>::~list() {
+  if (_release_nodes()) return;
+
   clear();
 
   _List_node_manager::deallocate(_a, _head, 1);
+  _List_node_manager::deallocate(_a, _tail, 1);
 }
 
-// template <typename T>
-// list<T> &list<T>::operator=(list &&l) {
-//   if (this != &l) {
-//     list(std::move(l)).swap(*this);
-//   }
-//   return *this;
-// }
+template <typename T, typename Alloc>
+list<T, Alloc> &list<T, Alloc>::operator=(list const &l) {
+  if (this != &l) {
+    list(l).swap(*this);
+  }
+  return *this;
+}
 
-template <typename T>
-typename list<T>::reference list<T>::front() {
+template <typename T, typename Alloc>
+list<T, Alloc> &list<T, Alloc>::operator=(list &&l) {
+  if (this != &l) {
+    list(std::move(l)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc>
+typename list<T, Alloc>::reference list<T, Alloc>::front() {
   return _head->_next->_data;
 }
 
-template <typename T>
-typename list<T>::const_reference list<T>::front() const {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::const_reference list<T, Alloc>::front() const {
   return _head->_next->_data;
 }
 
-template <typename T>
-typename list<T>::reference list<T>::back() {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::reference list<T, Alloc>::back() {
   return _tail->_prev->_data;
 }
 
-template <typename T>
-typename list<T>::const_reference list<T>::back() const {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::const_reference list<T, Alloc>::back() const {
   return _tail->_prev->_data;
 }
 
-template <typename T>
-typename list<T>::iterator list<T>::begin() noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::begin() noexcept {
   return list_iterator(_head->_next);
 }
 
-template <typename T>
-typename list<T>::iterator list<T>::end() noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::end() noexcept {
   return list_iterator(_tail);
 }
 
-template <typename T>
-typename list<T>::reverse_iterator list<T>::rbegin() noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::reverse_iterator list<T, Alloc>::rbegin() noexcept {
   return reverse_list_iterator(_tail->_prev);
 }
 
-template <typename T>
-typename list<T>::reverse_iterator list<T>::rend() noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::reverse_iterator list<T, Alloc>::rend() noexcept {
   return reverse_list_iterator(_head);
 }
 
-template <typename T>
-bool list<T>::empty() const noexcept {
+template <typename T, typename Alloc>
+bool list<T, Alloc>::empty() const noexcept {
   return _head->_next == _tail;
 }
 
-template <typename T>
-typename list<T>::size_type list<T>::size() const noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::size_type list<T, Alloc>::size() const noexcept {
   return _size;
 }
 
-template <typename T>
-typename list<T>::size_type list<T>::max_size() const noexcept {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::size_type list<T, Alloc>::max_size() const noexcept {
   return _List_node_manager::max_size(_a);
 }
 
-template <typename T>
-void list<T>::clear() {
+template <typename T, typename Alloc>
+void list<T, Alloc>::clear() {
+  if (_release_nodes()) {
+    _create_sentinels();
+    return;
+  }
+
   while (!empty()) {
     pop_front();
   }
 }
 
-template <typename T>
-typename list<T>::iterator list<T>::insert(iterator pos,
-                                           const_reference value) {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(
+    iterator pos, const_reference value) {
+  return emplace(pos, value);
+}
+
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(iterator pos,
+                                                         value_type &&value) {
+  return emplace(pos, std::move(value));
+}
+
+template <typename T, typename Alloc>
+template <typename InputIt, typename>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(iterator pos,
+                                                         InputIt first,
+                                                         InputIt last) {
+  return _insert_range(pos, first, last);
+}
+
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(
+    iterator pos, std::initializer_list<value_type> items) {
+  return _insert_range(pos, items.begin(), items.end());
+}
+
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::insert(
+    iterator pos, size_type n, const_reference value) {
+  return _insert_n(pos, n, value);
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::assign(size_type n, const_reference value) {
+  auto it = begin();
+  for (; it != end() && n > 0; ++it, --n) *it = value;
+
+  if (n > 0) {
+    _insert_n(end(), n, value);
+  } else {
+    while (it != end()) erase(it++);
+  }
+}
+
+template <typename T, typename Alloc>
+template <typename InputIt, typename>
+void list<T, Alloc>::assign(InputIt first, InputIt last) {
+  auto it = begin();
+  for (; it != end() && first != last; ++it, ++first) *it = *first;
+
+  if (first != last) {
+    _insert_range(end(), first, last);
+  } else {
+    while (it != end()) erase(it++);
+  }
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::assign(std::initializer_list<value_type> items) {
+  assign(items.begin(), items.end());
+}
+
+// Аллокатор с пулом (slab_allocator) может заранее выделить место под n
+// узлов одним блоком
+template <typename A, typename = void>
+struct _has_reserve : std::false_type {};
+
+template <typename A>
+struct _has_reserve<A, std::void_t<decltype(std::declval<A &>().reserve(
+                           std::declval<std::size_t>()))>> : std::true_type {};
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::_reserve_nodes(size_type n) {
+  if constexpr (_has_reserve<_Node_alloc_type>::value) {
+    _a.reserve(n);
+  }
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+typename list<T, Alloc>::list_node *list<T, Alloc>::_make_node(
+    Args &&...args) {
   auto node = _List_node_manager::allocate(_a, 1);
-  _List_node_manager::construct(_a, node, value);
+  try {
+    _List_node_manager::construct(_a, node, std::forward<Args>(args)...);
+  } catch (...) {
+    _List_node_manager::deallocate(_a, node, 1);
+    throw;
+  }
+  return node;
+}
 
-  insert(pos, node);
+// Освобождение цепочки, ещё не подцеплённой к списку
+template <typename T, typename Alloc>
+void list<T, Alloc>::_free_chain(list_node *first) noexcept {
+  while (first != nullptr) {
+    list_node *next = first->_next;
+    // Деструктор узла перецепляет соседей — отвязываем узел заранее
+    first->_prev = first->_next = first;
+    _List_node_manager::destroy(_a, first);
+    _List_node_manager::deallocate(_a, first, 1);
+    first = next;
+  }
+}
 
-  return list_iterator(node);
+template <typename T, typename Alloc>
+typename list<T, Alloc>::iterator list<T, Alloc>::_link_chain(
+    iterator pos, list_node *first, list_node *last, size_type n) noexcept {
+  if (n == 0) return pos;
+
+  list_node *p = pos._node;
+  first->_prev = p->_prev;
+  last->_next = p;
+  p->_prev->_next = first;
+  p->_prev = last;
+  _size += n;
+
+  return list_iterator(first);
+}
+
+template <typename T, typename Alloc>
+template <typename InputIt>
+typename list<T, Alloc>::iterator list<T, Alloc>::_insert_range(
+    iterator pos, InputIt first, InputIt last) {
+  using category = typename std::iterator_traits<InputIt>::iterator_category;
+  if constexpr (std::is_convertible_v<category, std::forward_iterator_tag>) {
+    _reserve_nodes(static_cast<size_type>(std::distance(first, last)));
+  }
+
+  list_node *chain_first = nullptr;
+  list_node *chain_last = nullptr;
+  size_type n = 0;
+  try {
+    for (; first != last; ++first, ++n) {
+      list_node *node = _make_node(*first);
+      node->_next = nullptr;
+      if (chain_last != nullptr) {
+        chain_last->_next = node;
+        node->_prev = chain_last;
+      } else {
+        chain_first = node;
+      }
+      chain_last = node;
+    }
+  } catch (...) {
+    _free_chain(chain_first);
+    throw;
+  }
+
+  return _link_chain(pos, chain_first, chain_last, n);
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+typename list<T, Alloc>::iterator list<T, Alloc>::_insert_n(
+    iterator pos, size_type n, Args const &...args) {
+  _reserve_nodes(n);
+
+  list_node *chain_first = nullptr;
+  list_node *chain_last = nullptr;
+  try {
+    for (size_type i = 0; i < n; i++) {
+      list_node *node = _make_node(args...);
+      node->_next = nullptr;
+      if (chain_last != nullptr) {
+        chain_last->_next = node;
+        node->_prev = chain_last;
+      } else {
+        chain_first = node;
+      }
+      chain_last = node;
+    }
+  } catch (...) {
+    _free_chain(chain_first);
+    throw;
+  }
+
+  return _link_chain(pos, chain_first, chain_last, n);
 }
 
-template <typename T>
-void list<T>::insert(iterator _pos, list_node *_node) noexcept {
+template <typename T, typename Alloc>
+void list<T, Alloc>::insert(iterator _pos, list_node *_node) noexcept {
   auto pos = _pos._node->_prev;
 
   _node->_prev = pos;
@@ -342,42 +708,136 @@ void list<T>::insert(iterator _pos, list_node *_node) noexcept {
   ++_size;
 }
 
-template <typename T>
+template <typename T, typename Alloc>
 template <typename... Args>
-typename list<T>::iterator list<T>::emplace(iterator pos, Args &&...args) {
-  ([&]() { insert(pos, args); }(), ...);
-  return --pos;
+typename list<T, Alloc>::iterator list<T, Alloc>::emplace(iterator pos,
+                                                          Args &&...args) {
+  auto node = _make_node(std::forward<Args>(args)...);
+
+  insert(pos, node);
+
+  return list_iterator(node);
 }
 
-template <typename T>
-void list<T>::remove_value(const_reference value) {
-  for (auto it = begin(); it != end(); it++) {
-    if (*it == value) {
-      auto next = ++it;
-      erase(it);
+template <typename T, typename Alloc>
+typename list<T, Alloc>::size_type list<T, Alloc>::remove_value(
+    const_reference value) {
+  return _remove_nodes(
+      [&value](list_node *node) { return node->_data == value; },
+      std::addressof(value));
+}
+
+template <typename T, typename Alloc>
+template <typename Predicate>
+typename list<T, Alloc>::size_type list<T, Alloc>::remove_if(Predicate pred) {
+  return _remove_nodes(
+      [&pred](list_node *node) {
+        return pred(static_cast<const_reference>(node->_data));
+      },
+      nullptr);
+}
+
+template <typename T, typename Alloc>
+template <typename Predicate>
+typename list<T, Alloc>::size_type list<T, Alloc>::parallel_remove_if(
+    Predicate pred, size_type threads) {
+  if (threads < 2 || _size < _parallel_remove_threshold) {
+    return remove_if(pred);
+  }
+
+  // Начала участков и флаги «удалить» для каждого элемента
+  size_type part = (_size + threads - 1) / threads;
+  std::vector<list_node *> starts;
+  size_type i = 0;
+  for (list_node *node = _head->_next; node != _tail; node = node->_next) {
+    if (i++ % part == 0) starts.push_back(node);
+  }
+  std::vector<unsigned char> flags(_size);
+
+  _run_parallel(
+      [&](size_type t) {
+        list_node *node = starts[t];
+        size_type end = std::min(_size, (t + 1) * part);
+        for (size_type k = t * part; k < end; k++, node = node->_next) {
+          flags[k] = pred(static_cast<const_reference>(node->_data));
+        }
+      },
+      starts.size());
+
+  i = 0;
+  return _remove_nodes([&flags, &i](list_node *) { return flags[i++] != 0; },
+                       nullptr);
+}
+
+template <typename T, typename Alloc>
+template <typename Doomed>
+typename list<T, Alloc>::size_type list<T, Alloc>::_remove_nodes(
+    Doomed doomed, value_type const *alias) {
+  size_type before = _size;
+  list_node *chain_first = nullptr;
+  list_node *chain_last = nullptr;
+  list_node *held = nullptr;
+  size_type pending = 0;
+
+  try {
+    for (list_node *node = _head->_next; node != _tail;) {
+      list_node *next = node->_next;
+      if (doomed(node)) {
+        node->_prev->_next = next;
+        next->_prev = node->_prev;
+        node->_next = nullptr;
+        --_size;
+
+        if (std::addressof(node->_data) == alias) {
+          held = node;
+        } else {
+          if (chain_last != nullptr) {
+            chain_last->_next = node;
+          } else {
+            chain_first = node;
+          }
+          chain_last = node;
+
+          if (++pending == _release_batch) {
+            _free_chain(chain_first);
+            chain_first = chain_last = nullptr;
+            pending = 0;
+          }
+        }
+      }
+      node = next;
     }
+  } catch (...) {
+    _free_chain(chain_first);
+    _free_chain(held);
+    throw;
   }
+
+  _free_chain(chain_first);
+  _free_chain(held);
+  return before - _size;
 }
 
-template <typename T>
-void list<T>::erase(size_type ind) {
+template <typename T, typename Alloc>
+void list<T, Alloc>::erase(size_type ind) {
   auto it = begin();
-  for (int i = 0; i < ind; i++) {
+  for (size_type i = 0; i < ind; i++) {
     it++;
   }
   erase(it);
 }
 
-template <typename T>
+template <typename T, typename Alloc>
 template <typename... Args>
-typename list<T>::iterator list<T>::emplace(size_type ind, Args &&...args) {
-  auto pos = at(ind);
-  ([&]() { insert(pos, args); }(), ...);
-  return --pos;
+typename list<T, Alloc>::iterator list<T, Alloc>::emplace(size_type ind,
+                                                          Args &&...args) {
+  auto pos = begin();
+  for (size_type i = 0; i < ind; i++) pos++;
+  return emplace(pos, std::forward<Args>(args)...);
 }
 
-template <typename T>
-void list<T>::erase(iterator pos) {
+template <typename T, typename Alloc>
+void list<T, Alloc>::erase(iterator pos) {
   if (!empty()) {
     _List_node_manager::destroy(_a, pos._node);
     _List_node_manager::deallocate(_a, pos._node, 1);
@@ -386,55 +846,68 @@ void list<T>::erase(iterator pos) {
   }
 }
 
-template <typename T>
-void list<T>::push_back(const_reference value) {
+template <typename T, typename Alloc>
+void list<T, Alloc>::push_back(const_reference value) {
   insert(end(), value);
 }
 
-template <typename T>
+template <typename T, typename Alloc>
+void list<T, Alloc>::push_back(value_type &&value) {
+  insert(end(), std::move(value));
+}
+
+template <typename T, typename Alloc>
 template <typename... Args>
-void list<T>::emplace_back(Args &&...args) {
-  ([&]() { push_back(args); }(), ...);
+typename list<T, Alloc>::reference list<T, Alloc>::emplace_back(
+    Args &&...args) {
+  return *emplace(end(), std::forward<Args>(args)...);
 }
 
-template <typename T>
-void list<T>::pop_back() {
+template <typename T, typename Alloc>
+void list<T, Alloc>::pop_back() {
   if (!empty()) {
     erase(--end());
   }
 }
 
-template <typename T>
-void list<T>::push_front(const_reference value) {
+template <typename T, typename Alloc>
+void list<T, Alloc>::push_front(const_reference value) {
   insert(begin(), value);
 }
 
-template <typename T>
+template <typename T, typename Alloc>
+void list<T, Alloc>::push_front(value_type &&value) {
+  insert(begin(), std::move(value));
+}
+
+template <typename T, typename Alloc>
 template <typename... Args>
-void list<T>::emplace_front(Args &&...args) {
-  ([&]() { push_front(args); }(), ...);
+typename list<T, Alloc>::reference list<T, Alloc>::emplace_front(
+    Args &&...args) {
+  return *emplace(begin(), std::forward<Args>(args)...);
 }
 
-template <typename T>
-bool list<T>::contains(const_reference value) {
+template <typename T, typename Alloc>
+bool list<T, Alloc>::contains(const_reference value) {
   for (auto it = begin(); it != end(); it++) {
     if (*it == value) return true;
   }
   return false;
 };
 
-template <typename T>
-typename list<T>::reference list<T>::at(size_type index) {
-  if (index > _size) throw std::logic_error("Index out of range");
+template <typename T, typename Alloc>
+typename list<T, Alloc>::reference list<T, Alloc>::at(size_type index) {
+  if (index >= _size) throw std::logic_error("Index out of range");
 
   auto it = begin();
-  for (int i = 0; i < index; i++) it++;
+  for (size_type i = 0; i < index; i++) it++;
 
   return *it;
 }
 
-template <typename T>
-typename list<T>::size_type list<T>::get_position(const_reference value) {
+template <typename T, typename Alloc>
+typename list<T, Alloc>::size_type list<T, Alloc>::get_position(
+    const_reference value) {
   size_type count = 0;
   for (auto it = begin(); it != end(); it++) {
     if (*it == value) return count;
@@ -443,16 +916,286 @@ typename list<T>::size_type list<T>::get_position(const_reference value) {
   return -1;
 }
 
-template <typename T>
-void list<T>::pop_front() {
+template <typename T, typename Alloc>
+void list<T, Alloc>::pop_front() {
   erase(begin());
 }
 
-template <typename T>
-void list<T>::swap(list &other) {
+template <typename T, typename Alloc>
+void list<T, Alloc>::swap(list &other) {
   std::swap(_head, other._head);
   std::swap(_tail, other._tail);
   std::swap(_size, other._size);
+  if constexpr (_List_node_manager::propagate_on_container_swap::value) {
+    std::swap(_a, other._a);
+  }
+}
+
+template <typename T, typename Alloc>
+typename list<T, Alloc>::allocator_type list<T, Alloc>::get_allocator() const {
+  return allocator_type(_a);
+}
+
+template <typename T, typename Alloc>
+bool list<T, Alloc>::_can_relink(list const &other) const noexcept {
+  if constexpr (_List_node_manager::is_always_equal::value) {
+    return true;
+  } else {
+    return _a == other._a;
+  }
+}
+
+// Перенос узлов [first, last) перед pos
+template <typename T, typename Alloc>
+void list<T, Alloc>::_transfer(list_node *pos, list_node *first,
+                               list_node *last) noexcept {
+  if (first == last || pos == first || pos == last) return;
+
+  list_node *before_last = last->_prev;
+
+  first->_prev->_next = last;
+  last->_prev = first->_prev;
+
+  pos->_prev->_next = first;
+  first->_prev = pos->_prev;
+  before_last->_next = pos;
+  pos->_prev = before_last;
+}
+
+// Отцепление всех узлов от ограничителей в цепочку
+template <typename T, typename Alloc>
+typename list<T, Alloc>::list_node *list<T, Alloc>::_cut_chain() noexcept {
+  if (empty()) return nullptr;
+
+  list_node *first = _head->_next;
+  _tail->_prev->_next = nullptr;
+
+  _head->_next = _tail;
+  _tail->_prev = _head;
+  return first;
+}
+
+// Подцепление цепочки между ограничителями с восстановлением _prev
+template <typename T, typename Alloc>
+void list<T, Alloc>::_attach_chain(list_node *first) noexcept {
+  list_node *prev = _head;
+  for (list_node *node = first; node != nullptr; node = node->_next) {
+    node->_prev = prev;
+    prev->_next = node;
+    prev = node;
+  }
+  prev->_next = _tail;
+  _tail->_prev = prev;
+}
+
+template <typename T, typename Alloc>
+template <typename Compare>
+typename list<T, Alloc>::list_node *list<T, Alloc>::_merge_chains(
+    list_node *a, list_node *b, Compare &comp) {
+  list_node *result = nullptr;
+  list_node **link = &result;
+
+  // При равенстве первым берётся узел из a — слияние устойчиво
+  while (a != nullptr && b != nullptr) {
+    if (comp(b->_data, a->_data)) {
+      *link = b;
+      b = b->_next;
+    } else {
+      *link = a;
+      a = a->_next;
+    }
+    link = &(*link)->_next;
+  }
+  *link = a ? a : b;
+
+  return result;
+}
+
+template <typename T, typename Alloc>
+template <typename Compare>
+typename list<T, Alloc>::list_node *list<T, Alloc>::_sort_chain(
+    list_node *first, Compare &comp) {
+  // runs[i] — отсортированная цепочка из 2^i узлов (или пустая)
+  list_node *runs[64] = {};
+
+  while (first != nullptr) {
+    list_node *carry = first;
+    first = first->_next;
+    carry->_next = nullptr;
+
+    size_type i = 0;
+    for (; runs[i] != nullptr; i++) {
+      carry = _merge_chains(runs[i], carry, comp);
+      runs[i] = nullptr;
+    }
+    runs[i] = carry;
+  }
+
+  list_node *result = nullptr;
+  for (auto run : runs) {
+    if (run != nullptr) result = _merge_chains(run, result, comp);
+  }
+  return result;
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::splice(iterator pos, list &other) {
+  if (this == &other || other.empty()) return;
+
+  splice(pos, other, other.begin(), other.end(), other._size);
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::splice(iterator pos, list &other, iterator it) {
+  auto last = it;
+  splice(pos, other, it, ++last, 1);
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::splice(iterator pos, list &other, iterator first,
+                            iterator last) {
+  size_type n = 0;
+  for (auto it = first; it != last; ++it) n++;
+
+  splice(pos, other, first, last, n);
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::splice(iterator pos, list &other, iterator first,
+                            iterator last, size_type n) {
+  if (first == last) return;
+
+  if (this == &other) {
+    _transfer(pos._node, first._node, last._node);
+    return;
+  }
+
+  if (_can_relink(other)) {
+    _transfer(pos._node, first._node, last._node);
+    _size += n;
+    other._size -= n;
+    return;
+  }
+
+  // Узлы принадлежат чужому пулу — переносим значения
+  while (first != last) {
+    emplace(pos, std::move(*first));
+    other.erase(first++);
+  }
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::merge(list &other) {
+  merge(other, std::less<value_type>());
+}
+
+template <typename T, typename Alloc>
+template <typename Compare>
+void list<T, Alloc>::merge(list &other, Compare comp) {
+  if (this == &other || other.empty()) return;
+
+  // Граница между своими и перенесёнными узлами
+  list_node *mid = _tail->_prev;
+  splice(end(), other);
+
+  list_node *first = _cut_chain();
+  list_node *second = mid->_next;
+  if (mid == _head) {
+    second = first;
+    first = nullptr;
+  } else {
+    mid->_next = nullptr;
+  }
+
+  _attach_chain(_merge_chains(first, second, comp));
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::sort() {
+  sort(std::less<value_type>());
+}
+
+template <typename T, typename Alloc>
+template <typename Compare>
+void list<T, Alloc>::sort(Compare comp) {
+  _attach_chain(_sort_chain(_cut_chain(), comp));
+}
+
+template <typename T, typename Alloc>
+template <typename Job>
+void list<T, Alloc>::_run_parallel(Job &&job, size_type count) {
+  std::vector<std::thread> workers;
+  for (size_type i = 1; i < count; i++) workers.emplace_back(job, i);
+  job(0);
+  for (auto &w : workers) w.join();
+}
+
+template <typename T, typename Alloc>
+template <typename Compare>
+void list<T, Alloc>::parallel_sort(Compare comp, size_type threads) {
+  if (threads < 2 || _size < _parallel_sort_threshold) {
+    sort(comp);
+    return;
+  }
+
+  // Разрезание на threads цепочек примерно равной длины
+  size_type part = (_size + threads - 1) / threads;
+  std::vector<list_node *> chains;
+  list_node *node = _cut_chain();
+  while (node != nullptr) {
+    chains.push_back(node);
+    for (size_type i = 1; i < part && node->_next != nullptr; i++) {
+      node = node->_next;
+    }
+    list_node *next = node->_next;
+    node->_next = nullptr;
+    node = next;
+  }
+
+  // Каждая цепочка сортируется своим потоком, затем цепочки сливаются
+  // попарно, тоже параллельно
+  _run_parallel(
+      [&chains, comp](size_type i) mutable {
+        chains[i] = _sort_chain(chains[i], comp);
+      },
+      chains.size());
+
+  while (chains.size() > 1) {
+    size_type pairs = chains.size() / 2;
+    _run_parallel(
+        [&chains, comp](size_type i) mutable {
+          chains[2 * i] = _merge_chains(chains[2 * i], chains[2 * i + 1], comp);
+        },
+        pairs);
+
+    size_type kept = 0;
+    for (size_type i = 0; i < chains.size(); i += 2) chains[kept++] = chains[i];
+    chains.resize(kept);
+  }
+
+  _attach_chain(chains.front());
+}
+
+template <typename T, typename Alloc>
+void list<T, Alloc>::unique() {
+  unique(std::equal_to<value_type>());
+}
+
+template <typename T, typename Alloc>
+template <typename BinaryPredicate>
+void list<T, Alloc>::unique(BinaryPredicate pred) {
+  if (empty()) return;
+
+  auto it = begin();
+  auto next = it;
+  while (++next != end()) {
+    if (pred(*it, *next)) {
+      erase(next);
+      next = it;
+    } else {
+      it = next;
+    }
+  }
 }
 
-#endif  // LIST_H_
\ No newline at end of file
+#endif  // LIST_H_
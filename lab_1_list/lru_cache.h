@@ -0,0 +1,479 @@
+#ifndef LRU_CACHE_H_
+#define LRU_CACHE_H_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "list.h"
+
+/// Вес записи по умолчанию: ёмкость кеша задаётся числом записей
+struct lru_entry_weight {
+  template <typename K, typename V>
+  std::size_t operator()(K const &, V const &) const noexcept {
+    return 1;
+  }
+};
+
+/// Вес записи в байтах: размер ключа и значения, а для контейнеров (строк,
+/// векторов) ещё и их содержимое
+struct lru_byte_weight {
+  template <typename K, typename V>
+  std::size_t operator()(K const &key, V const &value) const noexcept {
+    return _bytes(key, 0) + _bytes(value, 0);
+  }
+
+ private:
+  template <typename U>
+  static auto _bytes(U const &x, int) noexcept
+      -> decltype(x.size(), std::size_t()) {
+    return sizeof(U) + x.size() * sizeof(*std::begin(x));
+  }
+
+  template <typename U>
+  static std::size_t _bytes(U const &, long) noexcept {
+    return sizeof(U);
+  }
+};
+
+/// Кеш с вытеснением давно не использованных записей. Записи лежат в list в
+/// порядке последнего обращения (первая — самая свежая), рядом хранится
+/// хеш-таблица «ключ → узел». Попадание перецепляет узел в начало списка
+/// через splice без выделения памяти; get, put и erase — O(1) в среднем.
+///
+/// Ёмкость ограничивает суммарный вес записей, вес считает Weigher:
+/// lru_entry_weight — число записей, lru_byte_weight — байты. При
+/// превышении ёмкости с конца списка вытесняются записи, для каждой
+/// вызывается обработчик on_evict.
+template <typename K, typename V, typename Weigher = lru_entry_weight,
+          typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+struct lru_cache {
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = std::size_t;
+  using hasher = Hash;
+  using key_equal = KeyEqual;
+  using evict_callback = std::function<void(key_type const &, mapped_type &)>;
+
+  /// Счётчики обращений
+  struct stats_type {
+    size_type hits = 0;
+    size_type misses = 0;
+    size_type evictions = 0;
+  };
+
+  /// Конструктор
+  explicit lru_cache(size_type capacity, Weigher weigher = Weigher());
+  lru_cache(lru_cache const &) = delete;
+  lru_cache(lru_cache &&) = default;
+
+  lru_cache &operator=(lru_cache const &) = delete;
+  lru_cache &operator=(lru_cache &&) = default;
+
+  /// Значение по ключу или nullptr. Найденная запись становится самой
+  /// свежей. Указатель действителен до следующего изменения кеша
+  mapped_type *get(key_type const &key);
+  /// То же без обновления порядка и счётчиков
+  mapped_type *peek(key_type const &key);
+
+  /// Опрос наличия ключа
+  bool contains(key_type const &key) const;
+
+  /// Запись значения. Возвращает true, если ключ добавлен, и false, если
+  /// значение существующей записи заменено
+  template <typename M>
+  bool put(key_type const &key, M &&value);
+
+  /// Удаление записи без вызова обработчика вытеснения
+  bool erase(key_type const &key);
+
+  /// Очистка кеша. Счётчики сохраняются
+  void clear();
+
+  /// Опрос числа записей
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+  /// Суммарный вес записей
+  size_type weight() const noexcept;
+  size_type capacity() const noexcept;
+  /// Изменение ёмкости; лишние записи вытесняются сразу
+  void set_capacity(size_type capacity);
+
+  /// Обработчик вытеснения. Вызывается до удаления записи и не должен
+  /// обращаться к кешу
+  void on_evict(evict_callback callback);
+
+  stats_type stats() const noexcept;
+  void reset_stats() noexcept;
+
+ private:
+  struct entry {
+    key_type _key;
+    mapped_type _value;
+    size_type _weight;
+
+    template <typename M>
+    entry(key_type const &key, M &&value, size_type weight)
+        : _key(key), _value(std::forward<M>(value)), _weight(weight) {}
+  };
+
+  using list_type = list<entry>;
+  using iterator = typename list_type::iterator;
+
+  // Индекс ссылается на ключи внутри узлов списка: узлы не перемещаются,
+  // поэтому ключ хранится в одном экземпляре
+  using _Key_ref = std::reference_wrapper<key_type const>;
+
+  struct _ref_hash {
+    hasher _hash;
+    size_type operator()(_Key_ref key) const { return _hash(key.get()); }
+  };
+
+  struct _ref_equal {
+    key_equal _eq;
+    bool operator()(_Key_ref a, _Key_ref b) const {
+      return _eq(a.get(), b.get());
+    }
+  };
+
+  using _Index_type =
+      std::unordered_map<_Key_ref, iterator, _ref_hash, _ref_equal>;
+
+  list_type _list;
+  _Index_type _index;
+  Weigher _weigher;
+  size_type _capacity;
+  size_type _weight;
+  stats_type _stats;
+  evict_callback _on_evict;
+
+  void _touch(iterator it);
+  void _evict_to(size_type limit);
+};
+
+/// Потокобезопасный кеш: ключи распределяются по хешу между shards
+/// независимыми lru_cache, каждый под своим мьютексом, так что потоки,
+/// обращающиеся к разным сегментам, не мешают друг другу. Ёмкость делится
+/// между сегментами поровну (первые capacity % shards сегментов получают
+/// на единицу больше), так что сумма ёмкостей равна capacity. Порядок
+/// вытеснения ведётся в каждом сегменте отдельно. Значения возвращаются
+/// копией, снятой под блокировкой.
+template <typename K, typename V, typename Weigher = lru_entry_weight,
+          typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+struct sharded_lru_cache {
+ public:
+  using cache_type = lru_cache<K, V, Weigher, Hash, KeyEqual>;
+  using key_type = K;
+  using mapped_type = V;
+  using size_type = std::size_t;
+  using stats_type = typename cache_type::stats_type;
+  using evict_callback = typename cache_type::evict_callback;
+
+  /// Конструктор
+  explicit sharded_lru_cache(size_type capacity, size_type shards = 16,
+                             Weigher weigher = Weigher());
+
+  std::optional<mapped_type> get(key_type const &key);
+  bool contains(key_type const &key) const;
+  template <typename M>
+  bool put(key_type const &key, M &&value);
+  bool erase(key_type const &key);
+  void clear();
+
+  size_type size() const;
+  size_type weight() const;
+  size_type capacity() const noexcept;
+
+  /// Обработчик вытеснения общий для всех сегментов и вызывается под
+  /// блокировкой сегмента
+  void on_evict(evict_callback callback);
+
+  /// Сумма счётчиков всех сегментов
+  stats_type stats() const;
+  void reset_stats();
+
+ private:
+  struct alignas(64) shard {
+    mutable std::mutex _mutex;
+    cache_type _cache;
+
+    shard(size_type capacity, Weigher const &weigher)
+        : _cache(capacity, weigher) {}
+  };
+
+  std::vector<std::unique_ptr<shard>> _shards;
+  Hash _hash;
+  size_type _capacity;
+
+  shard &_shard_of(key_type const &key) const;
+};
+
+template <typename K, typename V, typename W, typename H, typename E>
+lru_cache<K, V, W, H, E>::lru_cache(size_type capacity, W weigher)
+    : _weigher(weigher), _capacity(capacity), _weight(0) {}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::_touch(iterator it) {
+  _list.splice(_list.begin(), _list, it);
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::_evict_to(size_type limit) {
+  while (_weight > limit && !_list.empty()) {
+    entry &victim = _list.back();
+    _stats.evictions++;
+    if (_on_evict) _on_evict(victim._key, victim._value);
+
+    _index.erase(std::cref(victim._key));
+    _weight -= victim._weight;
+    _list.pop_back();
+  }
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::mapped_type *lru_cache<K, V, W, H, E>::get(
+    key_type const &key) {
+  auto found = _index.find(std::cref(key));
+  if (found == _index.end()) {
+    _stats.misses++;
+    return nullptr;
+  }
+
+  _stats.hits++;
+  _touch(found->second);
+  return &(*found->second)._value;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::mapped_type *lru_cache<K, V, W, H, E>::peek(
+    key_type const &key) {
+  auto found = _index.find(std::cref(key));
+  return found == _index.end() ? nullptr : &(*found->second)._value;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+bool lru_cache<K, V, W, H, E>::contains(key_type const &key) const {
+  return _index.find(std::cref(key)) != _index.end();
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+template <typename M>
+bool lru_cache<K, V, W, H, E>::put(key_type const &key, M &&value) {
+  auto found = _index.find(std::cref(key));
+  if (found != _index.end()) {
+    entry &e = *found->second;
+    e._value = std::forward<M>(value);
+    _weight -= e._weight;
+    e._weight = _weigher(e._key, e._value);
+    _weight += e._weight;
+    _touch(found->second);
+    _evict_to(_capacity);
+    return false;
+  }
+
+  entry &e = _list.emplace_front(key, std::forward<M>(value), 0);
+  try {
+    e._weight = _weigher(e._key, e._value);
+    _index.emplace(std::cref(e._key), _list.begin());
+  } catch (...) {
+    _list.pop_front();
+    throw;
+  }
+  _weight += e._weight;
+  _evict_to(_capacity);
+  return true;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+bool lru_cache<K, V, W, H, E>::erase(key_type const &key) {
+  auto found = _index.find(std::cref(key));
+  if (found == _index.end()) return false;
+
+  iterator it = found->second;
+  _weight -= (*it)._weight;
+  _index.erase(found);
+  _list.erase(it);
+  return true;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::clear() {
+  _index.clear();
+  _list.clear();
+  _weight = 0;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::size_type lru_cache<K, V, W, H, E>::size()
+    const noexcept {
+  return _list.size();
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+bool lru_cache<K, V, W, H, E>::empty() const noexcept {
+  return _list.empty();
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::size_type lru_cache<K, V, W, H, E>::weight()
+    const noexcept {
+  return _weight;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::size_type
+lru_cache<K, V, W, H, E>::capacity() const noexcept {
+  return _capacity;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::set_capacity(size_type capacity) {
+  _capacity = capacity;
+  _evict_to(_capacity);
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::on_evict(evict_callback callback) {
+  _on_evict = std::move(callback);
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename lru_cache<K, V, W, H, E>::stats_type lru_cache<K, V, W, H, E>::stats()
+    const noexcept {
+  return _stats;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void lru_cache<K, V, W, H, E>::reset_stats() noexcept {
+  _stats = stats_type();
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+sharded_lru_cache<K, V, W, H, E>::sharded_lru_cache(size_type capacity,
+                                                    size_type shards,
+                                                    W weigher)
+    : _capacity(capacity) {
+  if (shards == 0) shards = 1;
+  size_type per_shard = capacity / shards;
+  size_type extra = capacity % shards;
+  for (size_type i = 0; i < shards; i++) {
+    _shards.push_back(
+        std::make_unique<shard>(per_shard + (i < extra ? 1 : 0), weigher));
+  }
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename sharded_lru_cache<K, V, W, H, E>::shard &
+sharded_lru_cache<K, V, W, H, E>::_shard_of(key_type const &key) const {
+  // Старшие биты хеша перемешиваются с младшими: внутри сегмента таблица
+  // снова хеширует ключ, и её корзины не должны зависеть от номера сегмента
+  unsigned long long h = _hash(key);
+  h ^= h >> 17;
+  h *= 0x9E3779B97F4A7C15ull;
+  return *_shards[static_cast<size_type>(h >> 32) % _shards.size()];
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+std::optional<typename sharded_lru_cache<K, V, W, H, E>::mapped_type>
+sharded_lru_cache<K, V, W, H, E>::get(key_type const &key) {
+  shard &s = _shard_of(key);
+  std::lock_guard<std::mutex> lock(s._mutex);
+  if (mapped_type *value = s._cache.get(key)) return *value;
+  return std::nullopt;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+bool sharded_lru_cache<K, V, W, H, E>::contains(key_type const &key) const {
+  shard &s = _shard_of(key);
+  std::lock_guard<std::mutex> lock(s._mutex);
+  return s._cache.contains(key);
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+template <typename M>
+bool sharded_lru_cache<K, V, W, H, E>::put(key_type const &key, M &&value) {
+  shard &s = _shard_of(key);
+  std::lock_guard<std::mutex> lock(s._mutex);
+  return s._cache.put(key, std::forward<M>(value));
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+bool sharded_lru_cache<K, V, W, H, E>::erase(key_type const &key) {
+  shard &s = _shard_of(key);
+  std::lock_guard<std::mutex> lock(s._mutex);
+  return s._cache.erase(key);
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void sharded_lru_cache<K, V, W, H, E>::clear() {
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    s->_cache.clear();
+  }
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename sharded_lru_cache<K, V, W, H, E>::size_type
+sharded_lru_cache<K, V, W, H, E>::size() const {
+  size_type total = 0;
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    total += s->_cache.size();
+  }
+  return total;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename sharded_lru_cache<K, V, W, H, E>::size_type
+sharded_lru_cache<K, V, W, H, E>::weight() const {
+  size_type total = 0;
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    total += s->_cache.weight();
+  }
+  return total;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename sharded_lru_cache<K, V, W, H, E>::size_type
+sharded_lru_cache<K, V, W, H, E>::capacity() const noexcept {
+  return _capacity;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void sharded_lru_cache<K, V, W, H, E>::on_evict(evict_callback callback) {
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    s->_cache.on_evict(callback);
+  }
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+typename sharded_lru_cache<K, V, W, H, E>::stats_type
+sharded_lru_cache<K, V, W, H, E>::stats() const {
+  stats_type total;
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    stats_type part = s->_cache.stats();
+    total.hits += part.hits;
+    total.misses += part.misses;
+    total.evictions += part.evictions;
+  }
+  return total;
+}
+
+template <typename K, typename V, typename W, typename H, typename E>
+void sharded_lru_cache<K, V, W, H, E>::reset_stats() {
+  for (auto &s : _shards) {
+    std::lock_guard<std::mutex> lock(s->_mutex);
+    s->_cache.reset_stats();
+  }
+}
+
+#endif  // LRU_CACHE_H_
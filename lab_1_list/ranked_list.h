@@ -0,0 +1,621 @@
+#ifndef RANKED_LIST_H_
+#define RANKED_LIST_H_
+
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+/// Список с порядковым индексом. Узлы связаны в двусвязный список (обход
+/// за O(1) на шаг, как в list) и одновременно образуют декартово дерево по
+/// неявному ключу — позиции в списке. В каждом узле хранится размер его
+/// поддерева, поэтому доступ, вставка и удаление по номеру, а также номер
+/// узла по итератору выполняются за O(log n) в среднем.
+///
+/// Итераторы остаются действительными до удаления их элемента.
+template <typename T, typename Alloc = std::allocator<T>>
+struct ranked_list {
+ private:
+  struct list_node;
+  struct list_iterator;
+  struct reverse_list_iterator;
+
+ public:
+  using value_type = T;
+  using reference = value_type &;
+  using const_reference = value_type const &;
+  using iterator = list_iterator;
+  using reverse_iterator = reverse_list_iterator;
+  using size_type = std::size_t;
+  using allocator_type = Alloc;
+
+  /// Конструктор
+  ranked_list();
+  explicit ranked_list(std::initializer_list<value_type> const &items);
+  /// Конструктор копирования
+  ranked_list(ranked_list const &l);
+  ranked_list(ranked_list &&l);
+
+  /// Деструктор
+  ~ranked_list();
+
+  /// Присваивание копированием и перемещением
+  ranked_list &operator=(ranked_list const &l);
+  ranked_list &operator=(ranked_list &&l);
+
+  /// Опрос размера списка
+  size_type size() const noexcept;
+
+  /// Очистка списка
+  void clear();
+
+  /// Проверка списка на пустоту
+  bool empty() const noexcept;
+
+  /// Опрос наличия заданного значения
+  bool contains(const_reference value);
+
+  /// Чтение значения с заданным номером в списке и изменение значения с
+  /// заданным номером в списке. O(log n)
+  reference at(size_type index);
+
+  /// Получение позиции в списке для заданного значения. O(n)
+  size_type get_position(const_reference value);
+  /// Получение позиции элемента, на который указывает итератор. O(log n)
+  size_type get_position(iterator pos) const noexcept;
+
+  /// Включение нового значения
+  void push_front(const_reference value);
+  void push_back(const_reference value);
+
+  // Включение нового значения перед заданной позицией. O(log n)
+  iterator insert(iterator pos, const_reference value);
+  template <typename... Args>
+  iterator emplace(size_type pos, Args &&...args);
+  template <typename... Args>
+  iterator emplace(iterator pos, Args &&...args);
+
+  //Удаление заданного значения из списка
+  void remove_value(const_reference value);
+
+  // Удаление значения из позиции с заданным номером. O(log n)
+  void erase(size_type ind);
+  iterator erase(iterator pos);
+
+  reference front();
+  const_reference front() const;
+  reference back();
+  const_reference back() const;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  void pop_back();
+  void pop_front();
+  void swap(ranked_list &other);
+
+ private:
+  using _Node_alloc_type = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<list_node>;
+  using _List_node_manager = std::allocator_traits<_Node_alloc_type>;
+
+  _Node_alloc_type _a;
+  size_type _size;
+  list_node *_head;
+  list_node *_tail;
+  list_node *_root;
+  std::uint32_t _seed;
+
+  template <typename... Args>
+  iterator _emplace_at(list_node *pos, size_type ind, Args &&...args);
+  void _unlink(list_node *node) noexcept;
+
+  std::uint32_t _next_priority() noexcept;
+  static size_type _count(list_node *t) noexcept;
+  static void _update(list_node *t) noexcept;
+  static void _split(list_node *t, size_type k, list_node *&l,
+                     list_node *&r) noexcept;
+  static list_node *_merge(list_node *l, list_node *r) noexcept;
+  list_node *_select(size_type k) const noexcept;
+
+  struct list_node {
+    list_node *_prev;
+    list_node *_next;
+
+    // Декартово дерево по позиции
+    list_node *_left = nullptr;
+    list_node *_right = nullptr;
+    list_node *_parent = nullptr;
+    size_type _subtree = 1;
+    std::uint32_t _priority = 0;
+
+    value_type _data;
+
+    template <typename... Args>
+    explicit list_node(Args &&...args)
+        : _prev(this), _next(this), _data(std::forward<Args>(args)...) {}
+  };
+
+  struct list_iterator {
+    using _Self = list_iterator;
+
+    list_node *_node;
+
+    explicit list_iterator(list_node *node) noexcept : _node(node) {}
+
+    reference operator*() const noexcept { return _node->_data; }
+
+    _Self &operator++() noexcept {
+      _node = _node->_next;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _node->_prev;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+
+  struct reverse_list_iterator {
+    using _Self = reverse_list_iterator;
+
+    list_node *_node;
+
+    explicit reverse_list_iterator(list_node *node) noexcept : _node(node) {}
+
+    reference operator*() const noexcept { return _node->_data; }
+
+    _Self &operator++() noexcept {
+      _node = _node->_prev;
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      _node = _node->_next;
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return _node != other._node;
+    }
+  };
+};
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc>::ranked_list()
+    : _a(),
+      _size(0),
+      _head(nullptr),
+      _tail(nullptr),
+      _root(nullptr),
+      _seed(2463534242u) {
+  _head = _List_node_manager::allocate(_a, 1);
+  _tail = _List_node_manager::allocate(_a, 1);
+
+  _head->_next = _tail;
+  _head->_prev = _head;
+  _tail->_next = _tail;
+  _tail->_prev = _head;
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc>::ranked_list(
+    std::initializer_list<value_type> const &items)
+    : ranked_list() {
+  for (auto it = items.begin(); it != items.end(); ++it) {
+    push_back(*it);
+  }
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc>::ranked_list(ranked_list const &l) : ranked_list() {
+  for (auto node = l._head->_next; node != l._tail; node = node->_next) {
+    push_back(node->_data);
+  }
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc>::ranked_list(ranked_list &&l) : ranked_list() {
+  swap(l);
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc> &ranked_list<T, Alloc>::operator=(ranked_list const &l) {
+  if (this != &l) {
+    ranked_list(l).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc> &ranked_list<T, Alloc>::operator=(ranked_list &&l) {
+  if (this != &l) {
+    ranked_list(std::move(l)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc>
+ranked_list<T, Alloc>::~ranked_list() {
+  clear();
+
+  _List_node_manager::deallocate(_a, _head, 1);
+  _List_node_manager::deallocate(_a, _tail, 1);
+}
+
+template <typename T, typename Alloc>
+std::uint32_t ranked_list<T, Alloc>::_next_priority() noexcept {
+  // xorshift32
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+  return _seed;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::size_type ranked_list<T, Alloc>::_count(
+    list_node *t) noexcept {
+  return t ? t->_subtree : 0;
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::_update(list_node *t) noexcept {
+  t->_subtree = 1 + _count(t->_left) + _count(t->_right);
+  if (t->_left) t->_left->_parent = t;
+  if (t->_right) t->_right->_parent = t;
+}
+
+// Разделение дерева t на первые k элементов (l) и остальные (r)
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::_split(list_node *t, size_type k, list_node *&l,
+                                   list_node *&r) noexcept {
+  if (t == nullptr) {
+    l = r = nullptr;
+    return;
+  }
+  if (_count(t->_left) < k) {
+    _split(t->_right, k - _count(t->_left) - 1, t->_right, r);
+    l = t;
+  } else {
+    _split(t->_left, k, l, t->_left);
+    r = t;
+  }
+  _update(t);
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::list_node *ranked_list<T, Alloc>::_merge(
+    list_node *l, list_node *r) noexcept {
+  if (l == nullptr || r == nullptr) return l ? l : r;
+
+  if (l->_priority > r->_priority) {
+    l->_right = _merge(l->_right, r);
+    _update(l);
+    return l;
+  }
+  r->_left = _merge(l, r->_left);
+  _update(r);
+  return r;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::list_node *ranked_list<T, Alloc>::_select(
+    size_type k) const noexcept {
+  list_node *t = _root;
+  while (t != nullptr) {
+    size_type left = _count(t->_left);
+    if (k < left) {
+      t = t->_left;
+    } else if (k == left) {
+      return t;
+    } else {
+      k -= left + 1;
+      t = t->_right;
+    }
+  }
+  return _tail;
+}
+
+// Создание узла в позиции ind перед узлом pos списка
+template <typename T, typename Alloc>
+template <typename... Args>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::_emplace_at(
+    list_node *pos, size_type ind, Args &&...args) {
+  auto node = _List_node_manager::allocate(_a, 1);
+  try {
+    _List_node_manager::construct(_a, node, std::forward<Args>(args)...);
+  } catch (...) {
+    _List_node_manager::deallocate(_a, node, 1);
+    throw;
+  }
+  node->_priority = _next_priority();
+
+  node->_prev = pos->_prev;
+  node->_next = pos;
+  pos->_prev->_next = node;
+  pos->_prev = node;
+
+  list_node *l, *r;
+  _split(_root, ind, l, r);
+  _root = _merge(_merge(l, node), r);
+  _root->_parent = nullptr;
+  ++_size;
+
+  return list_iterator(node);
+}
+
+// Исключение узла из списка и из дерева: на его место встаёт слияние его
+// поддеревьев, размеры предков уменьшаются на единицу
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::_unlink(list_node *node) noexcept {
+  node->_prev->_next = node->_next;
+  node->_next->_prev = node->_prev;
+
+  list_node *parent = node->_parent;
+  list_node *sub = _merge(node->_left, node->_right);
+  if (sub) sub->_parent = parent;
+
+  if (parent == nullptr) {
+    _root = sub;
+  } else if (parent->_left == node) {
+    parent->_left = sub;
+  } else {
+    parent->_right = sub;
+  }
+  for (; parent != nullptr; parent = parent->_parent) --parent->_subtree;
+
+  --_size;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::reference ranked_list<T, Alloc>::front() {
+  return _head->_next->_data;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::const_reference ranked_list<T, Alloc>::front()
+    const {
+  return _head->_next->_data;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::reference ranked_list<T, Alloc>::back() {
+  return _tail->_prev->_data;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::const_reference ranked_list<T, Alloc>::back()
+    const {
+  return _tail->_prev->_data;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::iterator
+ranked_list<T, Alloc>::begin() noexcept {
+  return list_iterator(_head->_next);
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::end() noexcept {
+  return list_iterator(_tail);
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::reverse_iterator
+ranked_list<T, Alloc>::rbegin() noexcept {
+  return reverse_list_iterator(_tail->_prev);
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::reverse_iterator
+ranked_list<T, Alloc>::rend() noexcept {
+  return reverse_list_iterator(_head);
+}
+
+template <typename T, typename Alloc>
+bool ranked_list<T, Alloc>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::size_type ranked_list<T, Alloc>::size()
+    const noexcept {
+  return _size;
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::clear() {
+  auto node = _head->_next;
+  while (node != _tail) {
+    auto next = node->_next;
+    _List_node_manager::destroy(_a, node);
+    _List_node_manager::deallocate(_a, node, 1);
+    node = next;
+  }
+
+  _head->_next = _tail;
+  _tail->_prev = _head;
+  _root = nullptr;
+  _size = 0;
+}
+
+template <typename T, typename Alloc>
+bool ranked_list<T, Alloc>::contains(const_reference value) {
+  for (auto it = begin(); it != end(); it++) {
+    if (*it == value) return true;
+  }
+  return false;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::reference ranked_list<T, Alloc>::at(
+    size_type index) {
+  if (index >= _size) throw std::logic_error("Index out of range");
+
+  return _select(index)->_data;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::size_type ranked_list<T, Alloc>::get_position(
+    const_reference value) {
+  size_type count = 0;
+  for (auto it = begin(); it != end(); it++) {
+    if (*it == value) return count;
+    count++;
+  }
+  return -1;
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::size_type ranked_list<T, Alloc>::get_position(
+    iterator pos) const noexcept {
+  list_node *node = pos._node;
+  if (node == _tail) return _size;
+
+  size_type rank = _count(node->_left);
+  for (; node->_parent != nullptr; node = node->_parent) {
+    if (node->_parent->_right == node) {
+      rank += _count(node->_parent->_left) + 1;
+    }
+  }
+  return rank;
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::push_front(const_reference value) {
+  _emplace_at(_head->_next, 0, value);
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::push_back(const_reference value) {
+  _emplace_at(_tail, _size, value);
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::insert(
+    iterator pos, const_reference value) {
+  return _emplace_at(pos._node, get_position(pos), value);
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::emplace(
+    size_type pos, Args &&...args) {
+  if (pos > _size) throw std::logic_error("Index out of range");
+
+  return _emplace_at(_select(pos), pos, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::emplace(
+    iterator pos, Args &&...args) {
+  return _emplace_at(pos._node, get_position(pos),
+                     std::forward<Args>(args)...);
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::remove_value(const_reference value) {
+  // value может ссылаться на элемент списка: его узел удаляется последним,
+  // чтобы сравнения с value не читали освобождённую память
+  iterator held = end();
+  for (auto it = begin(); it != end();) {
+    if (*it == value) {
+      if (std::addressof(*it) == std::addressof(value)) {
+        held = it++;
+      } else {
+        it = erase(it);
+      }
+    } else {
+      ++it;
+    }
+  }
+  if (held != end()) erase(held);
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::erase(size_type ind) {
+  if (ind >= _size) throw std::logic_error("Index out of range");
+
+  erase(list_iterator(_select(ind)));
+}
+
+template <typename T, typename Alloc>
+typename ranked_list<T, Alloc>::iterator ranked_list<T, Alloc>::erase(
+    iterator pos) {
+  list_node *node = pos._node;
+  if (node == _tail || node == _head) return end();
+
+  auto next = node->_next;
+  _unlink(node);
+  _List_node_manager::destroy(_a, node);
+  _List_node_manager::deallocate(_a, node, 1);
+
+  return list_iterator(next);
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::pop_back() {
+  if (!empty()) {
+    erase(--end());
+  }
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::pop_front() {
+  erase(begin());
+}
+
+template <typename T, typename Alloc>
+void ranked_list<T, Alloc>::swap(ranked_list &other) {
+  std::swap(_head, other._head);
+  std::swap(_tail, other._tail);
+  std::swap(_root, other._root);
+  std::swap(_size, other._size);
+  std::swap(_seed, other._seed);
+  if constexpr (_List_node_manager::propagate_on_container_swap::value) {
+    std::swap(_a, other._a);
+  }
+}
+
+#endif  // RANKED_LIST_H_
@@ -0,0 +1,247 @@
+#ifndef SLAB_ALLOCATOR_H_
+#define SLAB_ALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/// Пул ячеек фиксированного размера. Ячейки нарезаются из больших
+/// непрерывных блоков, освобождённые ячейки попадают в список свободных и
+/// переиспользуются. Блоки возвращаются системе только целиком
+class slab_pool {
+ public:
+  using size_type = std::size_t;
+
+  slab_pool(size_type chunk_size, size_type chunk_align,
+            size_type chunks_per_block)
+      : _chunk_align(std::max(chunk_align, alignof(free_chunk))),
+        _chunk_size(round_up(std::max(chunk_size, sizeof(free_chunk)),
+                             _chunk_align)),
+        _chunks_per_block(chunks_per_block ? chunks_per_block : 1) {}
+
+  slab_pool(slab_pool const &) = delete;
+  slab_pool &operator=(slab_pool const &) = delete;
+
+  ~slab_pool() { release(); }
+
+  /// Выделение одной ячейки
+  void *allocate() {
+    if (_free != nullptr) {
+      free_chunk *chunk = _free;
+      _free = chunk->next;
+      return chunk;
+    }
+    if (_cursor == _end) grow(_chunks_per_block);
+
+    void *chunk = _cursor;
+    _cursor += _chunk_size;
+    return chunk;
+  }
+
+  /// Возврат ячейки в список свободных
+  void deallocate(void *p) noexcept {
+    auto chunk = static_cast<free_chunk *>(p);
+    chunk->next = _free;
+    _free = chunk;
+  }
+
+  /// Подготовка места под n ячеек подряд: если в текущем блоке места
+  /// меньше, остаток блока уходит в список свободных и выделяется один блок
+  /// не меньше чем на n ячеек
+  void reserve(size_type n) {
+    if (static_cast<size_type>(_end - _cursor) / _chunk_size >= n) return;
+
+    for (; _cursor != _end; _cursor += _chunk_size) deallocate(_cursor);
+    grow(std::max(n, _chunks_per_block));
+  }
+
+  /// Освобождение всех блоков разом. Все выданные ячейки становятся
+  /// недействительными
+  void release() noexcept {
+    for (auto block : _blocks) {
+      ::operator delete(block, std::align_val_t(_chunk_align));
+    }
+    _blocks.clear();
+    _capacity = 0;
+    _free = nullptr;
+    _cursor = _end = nullptr;
+  }
+
+  size_type block_count() const noexcept { return _blocks.size(); }
+
+  /// Объём памяти, занятый блоками пула
+  size_type memory_usage() const noexcept { return _capacity; }
+
+ private:
+  struct free_chunk {
+    free_chunk *next;
+  };
+
+  static size_type round_up(size_type n, size_type align) noexcept {
+    return (n + align - 1) / align * align;
+  }
+
+  void grow(size_type chunks) {
+    size_type bytes = _chunk_size * chunks;
+
+    _blocks.reserve(_blocks.size() + 1);
+    auto block = static_cast<std::byte *>(
+        ::operator new(bytes, std::align_val_t(_chunk_align)));
+    _blocks.push_back(block);
+    _capacity += bytes;
+    _cursor = block;
+    _end = block + bytes;
+  }
+
+  size_type _chunk_align;
+  size_type _chunk_size;
+  size_type _chunks_per_block;
+  size_type _capacity = 0;
+
+  free_chunk *_free = nullptr;
+  std::byte *_cursor = nullptr;
+  std::byte *_end = nullptr;
+  std::vector<void *> _blocks;
+};
+
+/// Набор пулов по размерным классам. Общий для всех копий аллокатора и
+/// всех его rebind-вариантов: аллокатор узлов контейнера и аллокатор
+/// элементов, полученный через get_allocator(), берут ячейки из одного
+/// ресурса и могут освобождать память друг друга
+class slab_resource {
+ public:
+  using size_type = std::size_t;
+
+  slab_resource() = default;
+  slab_resource(slab_resource const &) = delete;
+  slab_resource &operator=(slab_resource const &) = delete;
+
+  /// Пул для ячеек заданного размера и выравнивания; создаётся при первом
+  /// обращении
+  slab_pool &pool(size_type chunk_size, size_type chunk_align,
+                  size_type chunks_per_block) {
+    if (slab_pool *p = find(chunk_size, chunk_align)) return *p;
+
+    _classes.reserve(_classes.size() + 1);
+    auto p = std::make_unique<slab_pool>(chunk_size, chunk_align,
+                                         chunks_per_block);
+    _classes.push_back({chunk_size, chunk_align, std::move(p)});
+    return *_classes.back().pool;
+  }
+
+  /// Уже созданный пул или nullptr
+  slab_pool *find(size_type chunk_size, size_type chunk_align) const noexcept {
+    for (auto const &c : _classes) {
+      if (c.size == chunk_size && c.align == chunk_align) return c.pool.get();
+    }
+    return nullptr;
+  }
+
+  /// Освобождение блоков всех пулов
+  void release() noexcept {
+    for (auto &c : _classes) c.pool->release();
+  }
+
+ private:
+  struct size_class {
+    size_type size;
+    size_type align;
+    std::unique_ptr<slab_pool> pool;
+  };
+
+  std::vector<size_class> _classes;
+};
+
+/// Аллокатор поверх slab_resource. Копии и rebind-варианты аллокатора
+/// разделяют ресурс и равны между собой; объекты одного размера берутся из
+/// общего пула. Каждый контейнер получает собственный ресурс (при
+/// копировании контейнера создаётся новый), поэтому контейнер может
+/// освободить все свои узлы одним вызовом release()
+template <typename T, std::size_t BlockSize = 1024>
+class slab_allocator {
+ public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using propagate_on_container_copy_assignment = std::false_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = slab_allocator<U, BlockSize>;
+  };
+
+  slab_allocator()
+      : _resource(std::make_shared<slab_resource>()),
+        _pool(&_resource->pool(sizeof(T), alignof(T), BlockSize)) {}
+
+  // Пул для T ищется или создаётся при первом выделении, поэтому
+  // преобразование не выделяет память и не бросает исключений
+  template <typename U>
+  explicit slab_allocator(slab_allocator<U, BlockSize> const &other) noexcept
+      : _resource(other._resource),
+        _pool(_resource->find(sizeof(T), alignof(T))) {}
+
+  T *allocate(size_type n) {
+    if (n == 1) return static_cast<T *>(own_pool().allocate());
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+  }
+
+  // Ячейку мог выделить равный аллокатор, поэтому пул для T уже существует
+  void deallocate(T *p, size_type n) noexcept {
+    if (n == 1) {
+      if (_pool == nullptr) _pool = _resource->find(sizeof(T), alignof(T));
+      _pool->deallocate(p);
+    } else {
+      ::operator delete(p, std::align_val_t(alignof(T)));
+    }
+  }
+
+  slab_allocator select_on_container_copy_construction() const {
+    return slab_allocator();
+  }
+
+  /// Выделение места под n узлов одним блоком
+  void reserve(size_type n) { own_pool().reserve(n); }
+
+  /// Освобождение всех блоков ресурса. Возможно, только если ресурс не
+  /// разделяется с другими экземплярами аллокатора
+  bool release() noexcept {
+    if (_resource.use_count() != 1) return false;
+    _resource->release();
+    return true;
+  }
+
+  /// Пул, из которого выделяются объекты T
+  slab_pool const &pool() const { return own_pool(); }
+
+  template <typename U>
+  bool operator==(slab_allocator<U, BlockSize> const &other) const noexcept {
+    return _resource == other._resource;
+  }
+  template <typename U>
+  bool operator!=(slab_allocator<U, BlockSize> const &other) const noexcept {
+    return _resource != other._resource;
+  }
+
+ private:
+  template <typename, std::size_t>
+  friend class slab_allocator;
+
+  slab_pool &own_pool() const {
+    if (_pool == nullptr) {
+      _pool = &_resource->pool(sizeof(T), alignof(T), BlockSize);
+    }
+    return *_pool;
+  }
+
+  std::shared_ptr<slab_resource> _resource;
+  mutable slab_pool *_pool;
+};
+
+#endif  // SLAB_ALLOCATOR_H_
@@ -0,0 +1,276 @@
+#ifndef TIMING_WHEEL_H_
+#define TIMING_WHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "intrusive_list.h"
+
+/// Иерархическое колесо таймеров. Время измеряется целыми тиками.
+///
+/// Колесо состоит из _levels уровней по _slots ячеек; ячейка уровня k
+/// покрывает 256^k тиков. Ячейки — intrusive_list, таймер входит в ячейку
+/// крючком, поэтому постановка и отмена — O(1) перецепление без выделения
+/// памяти. Когда младший уровень делает полный оборот, очередная ячейка
+/// старшего уровня раскладывается по младшим.
+///
+/// advance(now) продвигает время: сработавшие таймеры ячейки переносятся
+/// одним splice в отдельную пачку, и лишь затем для каждого вызывается
+/// обработчик, так что обработчик может ставить и отменять таймеры.
+///
+/// Записи таймеров выделяются блоками и после срабатывания или отмены
+/// возвращаются в список свободных.
+template <typename T>
+struct timing_wheel {
+ private:
+  struct timer_entry;
+
+ public:
+  using value_type = T;
+  using time_type = std::uint64_t;
+  using size_type = std::size_t;
+
+  /// Дескриптор таймера. Отмена по дескриптору уже сработавшего или
+  /// отменённого таймера ничего не делает
+  struct handle {
+    timer_entry *_entry = nullptr;
+    std::uint64_t _id = 0;
+  };
+
+  /// Конструктор
+  explicit timing_wheel(time_type now = 0);
+  timing_wheel(timing_wheel const &) = delete;
+  timing_wheel &operator=(timing_wheel const &) = delete;
+
+  /// Деструктор. Несработавшие таймеры уничтожаются без вызова обработчика
+  ~timing_wheel();
+
+  /// Постановка таймера на момент expires. Таймер с expires <= now()
+  /// сработает на ближайшем тике. O(1)
+  template <typename... Args>
+  handle schedule(time_type expires, Args &&...args);
+
+  /// Отмена таймера. O(1)
+  bool cancel(handle h) noexcept;
+
+  /// Ожидает ли таймер срабатывания
+  bool pending(handle h) const noexcept;
+
+  /// Продвижение времени до now включительно. Для каждого сработавшего
+  /// таймера вызывается on_expire(value_type &). Возвращает их число
+  template <typename F>
+  size_type advance(time_type now, F on_expire);
+
+  /// Опрос числа ожидающих таймеров
+  size_type size() const noexcept;
+  bool empty() const noexcept;
+
+  /// Текущее время колеса
+  time_type now() const noexcept;
+
+ private:
+  static constexpr unsigned _level_bits = 8;
+  static constexpr size_type _slots = size_type(1) << _level_bits;
+  static constexpr size_type _levels = 6;
+  static constexpr size_type _block_size = 4096;
+
+  struct timer_entry {
+    list_hook _hook;
+    std::uint64_t _id = 0;
+    time_type _expires = 0;
+    alignas(value_type) unsigned char _storage[sizeof(value_type)];
+
+    value_type *data() noexcept {
+      return std::launder(reinterpret_cast<value_type *>(_storage));
+    }
+  };
+
+  using slot_type = intrusive_list<timer_entry, &timer_entry::_hook>;
+
+  slot_type _wheel[_levels][_slots];
+  slot_type _free;
+  std::vector<std::unique_ptr<timer_entry[]>> _blocks;
+  time_type _now;
+  size_type _size;
+  std::uint64_t _next_id;
+
+  timer_entry *_take_entry();
+  void _place(timer_entry &e, time_type expires) noexcept;
+  void _cascade(size_type level) noexcept;
+  void _release(timer_entry &e) noexcept;
+};
+
+template <typename T>
+timing_wheel<T>::timing_wheel(time_type now)
+    : _now(now), _size(0), _next_id(1) {}
+
+template <typename T>
+timing_wheel<T>::~timing_wheel() {
+  for (auto &level : _wheel) {
+    for (auto &slot : level) {
+      for (auto &e : slot) e.data()->~value_type();
+      slot.clear();
+    }
+  }
+  _free.clear();
+}
+
+template <typename T>
+typename timing_wheel<T>::timer_entry *timing_wheel<T>::_take_entry() {
+  if (_free.empty()) {
+    _blocks.emplace_back(new timer_entry[_block_size]);
+    timer_entry *block = _blocks.back().get();
+    for (size_type i = 0; i < _block_size; i++) _free.push_back(block[i]);
+  }
+
+  timer_entry &e = _free.front();
+  _free.pop_front();
+  return &e;
+}
+
+// Выбор ячейки для момента expires >= _now: наименьший уровень, на котором
+// он отстоит от текущего меньше чем на оборот. Таймер с expires == _now
+// ложится в текущую ячейку младшего уровня. Далёкие таймеры ложатся в
+// последнюю ячейку старшего уровня и уточняются при раскладке
+template <typename T>
+void timing_wheel<T>::_place(timer_entry &e, time_type expires) noexcept {
+  for (size_type level = 0; level < _levels; level++) {
+    unsigned shift = static_cast<unsigned>(level) * _level_bits;
+    if ((expires >> shift) - (_now >> shift) < _slots) {
+      _wheel[level][(expires >> shift) & (_slots - 1)].push_back(e);
+      return;
+    }
+  }
+
+  unsigned shift = static_cast<unsigned>(_levels - 1) * _level_bits;
+  _wheel[_levels - 1][((_now >> shift) + _slots - 1) & (_slots - 1)]
+      .push_back(e);
+}
+
+// Раскладка текущей ячейки уровня level по младшим уровням. Раскладка идёт
+// до разбора ячейки младшего уровня на этом же тике, поэтому таймеры,
+// срабатывающие ровно сейчас, попадают в неё и не откладываются
+template <typename T>
+void timing_wheel<T>::_cascade(size_type level) noexcept {
+  unsigned shift = static_cast<unsigned>(level) * _level_bits;
+  slot_type pending_slot;
+  pending_slot.splice(pending_slot.end(),
+                      _wheel[level][(_now >> shift) & (_slots - 1)]);
+
+  while (!pending_slot.empty()) {
+    timer_entry &e = pending_slot.front();
+    pending_slot.pop_front();
+    _place(e, e._expires > _now ? e._expires : _now);
+  }
+}
+
+template <typename T>
+void timing_wheel<T>::_release(timer_entry &e) noexcept {
+  e.data()->~value_type();
+  e._id = 0;
+  _free.push_front(e);
+  --_size;
+}
+
+template <typename T>
+template <typename... Args>
+typename timing_wheel<T>::handle timing_wheel<T>::schedule(time_type expires,
+                                                           Args &&...args) {
+  timer_entry *e = _take_entry();
+  try {
+    ::new (static_cast<void *>(e->_storage))
+        value_type(std::forward<Args>(args)...);
+  } catch (...) {
+    _free.push_front(*e);
+    throw;
+  }
+
+  e->_id = _next_id++;
+  e->_expires = expires;
+  // Текущая ячейка младшего уровня уже разобрана: срок не раньше
+  // следующего тика
+  _place(*e, expires > _now ? expires : _now + 1);
+  ++_size;
+
+  return handle{e, e->_id};
+}
+
+template <typename T>
+bool timing_wheel<T>::pending(handle h) const noexcept {
+  return h._entry != nullptr && h._entry->_id == h._id &&
+         h._entry->_hook.is_linked();
+}
+
+template <typename T>
+bool timing_wheel<T>::cancel(handle h) noexcept {
+  if (!pending(h)) return false;
+
+  h._entry->_hook.unlink();
+  _release(*h._entry);
+  return true;
+}
+
+template <typename T>
+template <typename F>
+typename timing_wheel<T>::size_type timing_wheel<T>::advance(time_type now,
+                                                             F on_expire) {
+  size_type expired = 0;
+
+  while (_now < now) {
+    // Пустое колесо не нужно прокручивать по тику
+    if (_size == 0) {
+      _now = now;
+      break;
+    }
+
+    ++_now;
+    for (size_type level = _levels - 1; level > 0; level--) {
+      time_type lower = _now & ((time_type(1) << (level * _level_bits)) - 1);
+      if (lower == 0) _cascade(level);
+    }
+
+    slot_type batch;
+    batch.splice(batch.end(), _wheel[0][_now & (_slots - 1)]);
+
+    // Обработчик может отменить ещё не обработанные таймеры пачки: они
+    // просто исчезнут из неё. Если обработчик бросит исключение, остаток
+    // пачки сработает на следующем тике
+    while (!batch.empty()) {
+      timer_entry &e = batch.front();
+      batch.pop_front();
+      try {
+        on_expire(*e.data());
+      } catch (...) {
+        _release(e);
+        auto &next = _wheel[0][(_now + 1) & (_slots - 1)];
+        next.splice(next.begin(), batch);
+        throw;
+      }
+      _release(e);
+      expired++;
+    }
+  }
+
+  return expired;
+}
+
+template <typename T>
+typename timing_wheel<T>::size_type timing_wheel<T>::size() const noexcept {
+  return _size;
+}
+
+template <typename T>
+bool timing_wheel<T>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T>
+typename timing_wheel<T>::time_type timing_wheel<T>::now() const noexcept {
+  return _now;
+}
+
+#endif  // TIMING_WHEEL_H_
@@ -0,0 +1,605 @@
+#ifndef UNROLLED_LIST_H_
+#define UNROLLED_LIST_H_
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+/// Развёрнутый список: каждый узел хранит до N элементов подряд, поэтому при
+/// обходе промах кэша происходит один раз на узел, а не на каждый элемент.
+///
+/// Правила действительности итераторов: вставка и удаление делают
+/// недействительными только итераторы на элементы затронутых узлов (узла
+/// вставки/удаления и его соседа при разделении или слиянии). Итераторы на
+/// элементы остальных узлов остаются действительными, как и в list.
+template <typename T, std::size_t N = (sizeof(T) < 64 ? 256 / sizeof(T) : 4),
+          typename Alloc = std::allocator<T>>
+struct unrolled_list {
+  static_assert(N >= 2, "unrolled_list node must hold at least 2 elements");
+
+ private:
+  struct list_node;
+  struct list_iterator;
+  struct reverse_list_iterator;
+
+ public:
+  using value_type = T;
+  using reference = value_type &;
+  using const_reference = value_type const &;
+  using iterator = list_iterator;
+  using reverse_iterator = reverse_list_iterator;
+  using size_type = std::size_t;
+  using allocator_type = Alloc;
+
+  /// Вместимость одного узла
+  static constexpr size_type node_capacity = N;
+
+  /// Конструктор
+  unrolled_list();
+  explicit unrolled_list(std::initializer_list<value_type> const &items);
+  /// Конструктор копирования
+  unrolled_list(unrolled_list const &l);
+  unrolled_list(unrolled_list &&l);
+
+  /// Деструктор
+  ~unrolled_list();
+
+  /// Присваивание копированием и перемещением
+  unrolled_list &operator=(unrolled_list const &l);
+  unrolled_list &operator=(unrolled_list &&l);
+
+  /// Опрос размера списка
+  size_type size() const noexcept;
+
+  /// Очистка списка
+  void clear();
+
+  /// Проверка списка на пустоту
+  bool empty() const noexcept;
+
+  /// Опрос наличия заданного значения
+  bool contains(const_reference value);
+
+  /// Чтение значения с заданным номером в списке. Узлы пропускаются целиком,
+  /// трудоёмкость O(n / N)
+  reference at(size_type index);
+
+  /// Получение позиции в списке для заданного значения
+  size_type get_position(const_reference value);
+
+  /// Включение нового значения
+  void push_front(const_reference value);
+  void push_back(const_reference value);
+
+  /// Включение нового значения перед заданной позицией
+  iterator insert(iterator pos, const_reference value);
+
+  /// Удаление всех вхождений заданного значения за один проход. Узлы,
+  /// заполненные меньше чем наполовину, сливаются с предыдущими
+  void remove_value(const_reference value);
+
+  /// Удаление значения в заданной позиции, возвращает итератор на следующее
+  iterator erase(iterator pos);
+
+  reference front();
+  const_reference front() const;
+  reference back();
+  const_reference back() const;
+
+  iterator begin() noexcept;
+  iterator end() noexcept;
+
+  reverse_iterator rbegin() noexcept;
+  reverse_iterator rend() noexcept;
+
+  void pop_back();
+  void pop_front();
+  void swap(unrolled_list &other);
+
+ private:
+  using _Node_alloc_type = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<list_node>;
+  using _List_node_manager = std::allocator_traits<_Node_alloc_type>;
+
+  _Node_alloc_type _a;
+  size_type _size;
+  list_node *_head;
+  list_node *_tail;
+
+  list_node *_create_node(list_node *before);
+  void _destroy_node(list_node *node) noexcept;
+  void _split(list_node *node);
+  void _merge_next(list_node *node);
+
+  struct list_node {
+    list_node *_prev;
+    list_node *_next;
+    size_type _count;
+    alignas(value_type) unsigned char _storage[N * sizeof(value_type)];
+
+    list_node() noexcept : _prev(this), _next(this), _count(0) {}
+
+    value_type *data() noexcept {
+      return std::launder(reinterpret_cast<value_type *>(_storage));
+    }
+
+    bool full() const noexcept { return _count == N; }
+
+    // Вставка в позицию idx со сдвигом хвоста узла вправо
+    template <typename... Args>
+    void emplace(size_type idx, Args &&...args) {
+      value_type *d = data();
+      if (idx == _count) {
+        ::new (static_cast<void *>(d + idx))
+            value_type(std::forward<Args>(args)...);
+      } else {
+        value_type tmp(std::forward<Args>(args)...);
+        ::new (static_cast<void *>(d + _count))
+            value_type(std::move(d[_count - 1]));
+        std::move_backward(d + idx, d + _count - 1, d + _count);
+        d[idx] = std::move(tmp);
+      }
+      ++_count;
+    }
+
+    // Удаление элемента idx со сдвигом хвоста узла влево
+    void erase(size_type idx) {
+      value_type *d = data();
+      std::move(d + idx + 1, d + _count, d + idx);
+      --_count;
+      d[_count].~value_type();
+    }
+
+    void destroy_all() noexcept {
+      std::destroy(data(), data() + _count);
+      _count = 0;
+    }
+  };
+
+  struct list_iterator {
+    using _Self = list_iterator;
+
+    list_node *_node;
+    size_type _idx;
+
+    list_iterator(list_node *node, size_type idx) noexcept
+        : _node(node), _idx(idx) {}
+
+    reference operator*() const noexcept { return _node->data()[_idx]; }
+
+    _Self &operator++() noexcept {
+      if (++_idx >= _node->_count) {
+        _node = _node->_next;
+        _idx = 0;
+      }
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      if (_idx == 0) {
+        _node = _node->_prev;
+        _idx = _node->_count ? _node->_count - 1 : 0;
+      } else {
+        --_idx;
+      }
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node && _idx == other._idx;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return !(*this == other);
+    }
+  };
+
+  struct reverse_list_iterator {
+    using _Self = reverse_list_iterator;
+
+    list_node *_node;
+    size_type _idx;
+
+    reverse_list_iterator(list_node *node, size_type idx) noexcept
+        : _node(node), _idx(idx) {}
+
+    reference operator*() const noexcept { return _node->data()[_idx]; }
+
+    _Self &operator++() noexcept {
+      if (_idx == 0) {
+        _node = _node->_prev;
+        _idx = _node->_count ? _node->_count - 1 : 0;
+      } else {
+        --_idx;
+      }
+      return *this;
+    }
+
+    _Self operator++(int) noexcept {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    _Self &operator--() noexcept {
+      if (++_idx >= _node->_count) {
+        _node = _node->_next;
+        _idx = 0;
+      }
+      return *this;
+    }
+
+    _Self operator--(int) noexcept {
+      auto it = *this;
+      --(*this);
+      return it;
+    }
+
+    bool operator==(_Self const &other) const noexcept {
+      return _node == other._node && _idx == other._idx;
+    }
+
+    bool operator!=(_Self const &other) const noexcept {
+      return !(*this == other);
+    }
+  };
+};
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc>::unrolled_list()
+    : _a(), _size(0), _head(nullptr), _tail(nullptr) {
+  _head = _List_node_manager::allocate(_a, 1);
+  _List_node_manager::construct(_a, _head);
+  _tail = _List_node_manager::allocate(_a, 1);
+  _List_node_manager::construct(_a, _tail);
+
+  _head->_next = _tail;
+  _tail->_prev = _head;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc>::unrolled_list(
+    std::initializer_list<value_type> const &items)
+    : unrolled_list() {
+  for (auto it = items.begin(); it != items.end(); ++it) {
+    push_back(*it);
+  }
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc>::unrolled_list(unrolled_list const &l)
+    : unrolled_list() {
+  for (auto node = l._head->_next; node != l._tail; node = node->_next) {
+    auto copy = _create_node(_tail);
+    for (size_type i = 0; i < node->_count; i++) {
+      copy->emplace(i, node->data()[i]);
+    }
+    _size += copy->_count;
+  }
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc>::unrolled_list(unrolled_list &&l)
+    : unrolled_list() {
+  swap(l);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc>::~unrolled_list() {
+  clear();
+
+  _List_node_manager::destroy(_a, _head);
+  _List_node_manager::deallocate(_a, _head, 1);
+  _List_node_manager::destroy(_a, _tail);
+  _List_node_manager::deallocate(_a, _tail, 1);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc> &unrolled_list<T, N, Alloc>::operator=(
+    unrolled_list const &l) {
+  if (this != &l) {
+    unrolled_list(l).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+unrolled_list<T, N, Alloc> &unrolled_list<T, N, Alloc>::operator=(
+    unrolled_list &&l) {
+  if (this != &l) {
+    unrolled_list(std::move(l)).swap(*this);
+  }
+  return *this;
+}
+
+// Создание пустого узла перед узлом before
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::list_node *
+unrolled_list<T, N, Alloc>::_create_node(list_node *before) {
+  auto node = _List_node_manager::allocate(_a, 1);
+  _List_node_manager::construct(_a, node);
+
+  node->_prev = before->_prev;
+  node->_next = before;
+  before->_prev->_next = node;
+  before->_prev = node;
+
+  return node;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::_destroy_node(list_node *node) noexcept {
+  node->destroy_all();
+  node->_prev->_next = node->_next;
+  node->_next->_prev = node->_prev;
+
+  _List_node_manager::destroy(_a, node);
+  _List_node_manager::deallocate(_a, node, 1);
+}
+
+// Перенос верхней половины полного узла в новый узел следом за ним
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::_split(list_node *node) {
+  auto next = _create_node(node->_next);
+  size_type half = node->_count / 2;
+  value_type *d = node->data();
+
+  for (size_type i = half; i < node->_count; i++) {
+    next->emplace(next->_count, std::move(d[i]));
+  }
+  std::destroy(d + half, d + node->_count);
+  node->_count = half;
+}
+
+// Слияние узла со следующим, если их элементы помещаются в один узел
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::_merge_next(list_node *node) {
+  auto next = node->_next;
+  if (next == _tail || node->_count + next->_count > N) return;
+
+  value_type *d = next->data();
+  for (size_type i = 0; i < next->_count; i++) {
+    node->emplace(node->_count, std::move(d[i]));
+  }
+  _destroy_node(next);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::reference
+unrolled_list<T, N, Alloc>::front() {
+  return _head->_next->data()[0];
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::const_reference
+unrolled_list<T, N, Alloc>::front() const {
+  return _head->_next->data()[0];
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::reference
+unrolled_list<T, N, Alloc>::back() {
+  return _tail->_prev->data()[_tail->_prev->_count - 1];
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::const_reference
+unrolled_list<T, N, Alloc>::back() const {
+  return _tail->_prev->data()[_tail->_prev->_count - 1];
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::iterator
+unrolled_list<T, N, Alloc>::begin() noexcept {
+  return list_iterator(_head->_next, 0);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::iterator
+unrolled_list<T, N, Alloc>::end() noexcept {
+  return list_iterator(_tail, 0);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::reverse_iterator
+unrolled_list<T, N, Alloc>::rbegin() noexcept {
+  auto last = _tail->_prev;
+  return reverse_list_iterator(last, last->_count ? last->_count - 1 : 0);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::reverse_iterator
+unrolled_list<T, N, Alloc>::rend() noexcept {
+  return reverse_list_iterator(_head, 0);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+bool unrolled_list<T, N, Alloc>::empty() const noexcept {
+  return _size == 0;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::size_type
+unrolled_list<T, N, Alloc>::size() const noexcept {
+  return _size;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::clear() {
+  while (_head->_next != _tail) {
+    _destroy_node(_head->_next);
+  }
+  _size = 0;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::iterator
+unrolled_list<T, N, Alloc>::insert(iterator pos, const_reference value) {
+  list_node *node = pos._node;
+  size_type idx = pos._idx;
+
+  // Вставка в начало узла или в конец списка — дописываем в конец
+  // предыдущего узла, если там есть место
+  if (idx == 0 && node->_prev != _head && !node->_prev->full()) {
+    node = node->_prev;
+    idx = node->_count;
+  } else if (node == _tail) {
+    node = _create_node(_tail);
+    idx = 0;
+  } else if (node->full()) {
+    _split(node);
+    if (idx > node->_count) {
+      idx -= node->_count;
+      node = node->_next;
+    }
+  }
+
+  node->emplace(idx, value);
+  ++_size;
+
+  return list_iterator(node, idx);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::iterator
+unrolled_list<T, N, Alloc>::erase(iterator pos) {
+  list_node *node = pos._node;
+  size_type idx = pos._idx;
+  if (node == _tail || node == _head) return end();
+
+  node->erase(idx);
+  --_size;
+
+  if (node->_count == 0) {
+    auto next = node->_next;
+    _destroy_node(node);
+    return list_iterator(next, 0);
+  }
+
+  if (node->_count < N / 4) _merge_next(node);
+  if (idx == node->_count) return list_iterator(node->_next, 0);
+  return list_iterator(node, idx);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::remove_value(const_reference value) {
+  // value может ссылаться на элемент списка, который std::remove
+  // перезапишет: тогда сравнение идёт с его копией
+  value_type const *target = std::addressof(value);
+  std::optional<value_type> held;
+  std::less<value_type const *> before;
+
+  auto node = _head->_next;
+  while (node != _tail) {
+    value_type *d = node->data();
+    if (!held && !before(target, d) && before(target, d + node->_count)) {
+      held.emplace(value);
+      target = std::addressof(*held);
+    }
+
+    auto kept = std::remove(d, d + node->_count, *target);
+    size_type left = static_cast<size_type>(kept - d);
+
+    std::destroy(kept, d + node->_count);
+    _size -= node->_count - left;
+    node->_count = left;
+
+    // Предыдущий узел уже просмотрен, поэтому полупустой узел можно
+    // слить с ним, не нарушая обхода
+    auto next = node->_next;
+    if (node->_count == 0) {
+      _destroy_node(node);
+    } else if (node->_count < N / 2 && node->_prev != _head) {
+      _merge_next(node->_prev);
+    }
+    node = next;
+  }
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::push_back(const_reference value) {
+  insert(end(), value);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::push_front(const_reference value) {
+  insert(begin(), value);
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::pop_back() {
+  if (!empty()) {
+    erase(--end());
+  }
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::pop_front() {
+  if (!empty()) {
+    erase(begin());
+  }
+}
+
+template <typename T, std::size_t N, typename Alloc>
+bool unrolled_list<T, N, Alloc>::contains(const_reference value) {
+  for (auto node = _head->_next; node != _tail; node = node->_next) {
+    value_type *d = node->data();
+    if (std::find(d, d + node->_count, value) != d + node->_count) return true;
+  }
+  return false;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::reference unrolled_list<T, N, Alloc>::at(
+    size_type index) {
+  if (index >= _size) throw std::logic_error("Index out of range");
+
+  auto node = _head->_next;
+  while (index >= node->_count) {
+    index -= node->_count;
+    node = node->_next;
+  }
+  return node->data()[index];
+}
+
+template <typename T, std::size_t N, typename Alloc>
+typename unrolled_list<T, N, Alloc>::size_type
+unrolled_list<T, N, Alloc>::get_position(const_reference value) {
+  size_type count = 0;
+  for (auto node = _head->_next; node != _tail; node = node->_next) {
+    value_type *d = node->data();
+    auto it = std::find(d, d + node->_count, value);
+    if (it != d + node->_count) return count + static_cast<size_type>(it - d);
+    count += node->_count;
+  }
+  return -1;
+}
+
+template <typename T, std::size_t N, typename Alloc>
+void unrolled_list<T, N, Alloc>::swap(unrolled_list &other) {
+  std::swap(_head, other._head);
+  std::swap(_tail, other._tail);
+  std::swap(_size, other._size);
+  if constexpr (_List_node_manager::propagate_on_container_swap::value) {
+    std::swap(_a, other._a);
+  }
+}
+
+#endif  // UNROLLED_LIST_H_
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bstree.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Результаты вычислений сохраняются сюда, чтобы компилятор их не выбросил
+volatile long long sink;
+
+template <typename F>
+double measure_ms(F &&f) {
+  auto start = clock_type::now();
+  f();
+  std::chrono::duration<double, std::milli> d = clock_type::now() - start;
+  return d.count();
+}
+
+std::vector<int> shuffled_keys(std::size_t n, unsigned seed) {
+  std::vector<int> keys(n);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+  return keys;
+}
+
+// Полный обход дерева итераторами в обе стороны
+void bench_iteration() {
+  std::printf("%-32s %13s %13s\n", "Bst<int, int>, random keys", "forward",
+              "reverse");
+
+  for (std::size_t n : {10000u, 100000u, 1000000u}) {
+    Bst<int, int> tree;
+    for (int k : shuffled_keys(n, 1)) tree.insert(k, k);
+
+    long long sum = 0;
+    double forward_ms = measure_ms([&] {
+      for (auto it = tree.begin(); it != tree.end(); ++it) sum += *it;
+    });
+    double reverse_ms = measure_ms([&] {
+      for (auto it = tree.rbegin(); it != tree.rend(); ++it) sum += *it;
+    });
+    sink = sum;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%zu elements", n);
+    std::printf("%-32s %10.2f ms %10.2f ms\n", name, forward_ms, reverse_ms);
+  }
+}
+
+// Вставка, поиск, удаление половины ключей и разрушение дерева при
+// заданном порядке ключей
+void bench_order_row(char const *name, std::vector<int> const &keys) {
+  auto tree = std::make_unique<Bst<int, int>>();
+  long long sum = 0;
+
+  double insert_ms = measure_ms([&] {
+    for (int k : keys) tree->insert(k, k);
+  });
+  double find_ms = measure_ms([&] {
+    for (int k : keys) sum += tree->at(k);
+  });
+  double remove_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < keys.size(); i += 2) tree->remove(keys[i]);
+  });
+  double teardown_ms = measure_ms([&] { tree.reset(); });
+  sink = sum;
+
+  std::printf("%-24s %9.2f ms %9.2f ms %9.2f ms %9.2f ms\n", name, insert_ms,
+              find_ms, remove_ms, teardown_ms);
+}
+
+void bench_orders() {
+  std::printf("\n%-24s %12s %12s %12s %12s\n", "Bst<int, int>", "insert",
+              "find", "remove 1/2", "teardown");
+
+  std::vector<int> sorted(30000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  bench_order_row("3*10^4 sorted keys", sorted);
+  bench_order_row("3*10^4 random keys", shuffled_keys(30000, 2));
+  bench_order_row("10^6 random keys", shuffled_keys(1000000, 3));
+}
+
+// Цикл перестроения индекса: построение, обновление половины ключей
+// (удаление и повторная вставка) и очистка
+template <typename Tree>
+void bench_rebuild_row(char const *name, std::vector<int> const &keys) {
+  Tree tree;
+  double build_ms = measure_ms([&] {
+    for (int k : keys) tree.insert(k, k);
+  });
+  double churn_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < keys.size(); i += 2) tree.remove(keys[i]);
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+      tree.insert(keys[i], keys[i]);
+    }
+  });
+  double clear_ms = measure_ms([&] { tree.clear(); });
+  sink = static_cast<long long>(tree.size());
+
+  std::printf("%-24s %9.2f ms %9.2f ms %9.2f ms\n", name, build_ms, churn_ms,
+              clear_ms);
+}
+
+void bench_rebuild() {
+  std::printf("\n%-24s %12s %12s %12s\n", "10^6 random keys", "build",
+              "churn 1/2", "clear");
+
+  auto keys = shuffled_keys(1000000, 4);
+  bench_rebuild_row<Bst<int, int>>("std::allocator", keys);
+  bench_rebuild_row<PooledBst<int, int>>("slab_allocator", keys);
+}
+
+// Время построения дерева; разрушение в замер не входит
+template <typename Build>
+void bench_build_row(char const *name, Build build) {
+  using tree_type = decltype(build());
+  std::unique_ptr<tree_type> tree;
+  double build_ms =
+      measure_ms([&] { tree = std::make_unique<tree_type>(build()); });
+  sink = static_cast<long long>(tree->size());
+
+  std::printf("%-24s %9.2f ms\n", name, build_ms);
+}
+
+// Загрузка отсортированного массива пар
+void bench_bulk_load() {
+  std::size_t const n = 1000000;
+  std::printf("\n%-24s %12s\n", "10^6 sorted pairs", "build");
+
+  std::vector<std::pair<int, int>> items(n);
+  for (std::size_t i = 0; i < n; i++) {
+    items[i] = {static_cast<int>(i), static_cast<int>(i)};
+  }
+
+  // Первое построение платит за получение страниц у системы, поэтому
+  // оно не замеряется
+  Bst<int, int>::from_sorted(items.begin(), items.end());
+
+  bench_build_row("from_sorted", [&] {
+    return Bst<int, int>::from_sorted(items.begin(), items.end());
+  });
+  bench_build_row("parallel_from_sorted", [&] {
+    return Bst<int, int>::parallel_from_sorted(items.begin(), items.end());
+  });
+  bench_build_row("from_sorted, slab", [&] {
+    return PooledBst<int, int>::from_sorted(items.begin(), items.end());
+  });
+  // Вставка отсортированных ключей по одному вырождает Bst в список,
+  // поэтому для сравнения ключи вставляются в случайном порядке
+  bench_build_row("insert, random order", [&] {
+    Bst<int, int> tree;
+    for (int k : shuffled_keys(n, 5)) tree.insert(k, k);
+    return tree;
+  });
+}
+
+// Запросы по окну ключей [lo, lo + width): range() против полного обхода
+// с отбором по ключу. Время на один запрос
+void bench_range_scan() {
+  std::size_t const n = 1000000;
+  std::size_t const queries = 10000;
+  std::size_t const scans = 10;
+  int const width = 100;
+
+  Bst<int, int> tree;
+  for (int k : shuffled_keys(n, 8)) tree.insert(k, k);
+  auto starts = shuffled_keys(n - static_cast<std::size_t>(width), 9);
+
+  long long sum = 0;
+  double range_ms = measure_ms([&] {
+    for (std::size_t q = 0; q < queries; q++) {
+      for (int v : tree.range(starts[q], starts[q] + width)) sum += v;
+    }
+  });
+  double scan_ms = measure_ms([&] {
+    for (std::size_t q = 0; q < scans; q++) {
+      for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (it.key() >= starts[q] && it.key() < starts[q] + width) sum += *it;
+      }
+    }
+  });
+  sink = sum;
+
+  std::printf("\n%-24s %12s %12s\n", "10^6 keys, window 100", "range()",
+              "full scan");
+  std::printf("%-24s %9.3f us %9.3f us\n", "per query",
+              range_ms * 1000 / static_cast<double>(queries),
+              scan_ms * 1000 / static_cast<double>(scans));
+}
+
+// Ключи std::string длиннее буфера короткой строки и данные по 256 байт:
+// включение копированием против try_emplace с переносом, поиск по
+// std::string_view с построением временного ключа и без него
+void bench_string_keys() {
+  std::size_t const n = 200000;
+  std::vector<std::string> keys;
+  for (int k : shuffled_keys(n, 10)) {
+    char buf[40];
+    std::snprintf(buf, sizeof(buf), "user-profile-key-%016d", k);
+    keys.emplace_back(buf);
+  }
+  std::string const data(256, 'x');
+
+  std::printf("\n%-32s %13s\n", "Bst<string, string>, 2*10^5", "time");
+  Bst<std::string, std::string> copied;
+  double copy_ms = measure_ms([&] {
+    for (auto const &k : keys) copied.insert(k, data);
+  });
+  std::printf("%-32s %10.2f ms\n", "insert(k, v), copies", copy_ms);
+
+  auto moved_keys = keys;
+  std::vector<std::string> values(n, data);
+  Bst<std::string, std::string> tree;
+  double move_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < n; i++) {
+      tree.try_emplace(std::move(moved_keys[i]), std::move(values[i]));
+    }
+  });
+  std::printf("%-32s %10.2f ms\n", "try_emplace, moved", move_ms);
+
+  std::vector<std::string_view> queries(keys.begin(), keys.end());
+  long long found = 0;
+  double temp_ms = measure_ms([&] {
+    for (auto q : queries) found += tree.find(std::string(q)) != tree.end();
+  });
+  double view_ms = measure_ms([&] {
+    for (auto q : queries) found += tree.find(q) != tree.end();
+  });
+  sink = found;
+  std::printf("%-32s %10.2f ms\n", "find(std::string(view))", temp_ms);
+  std::printf("%-32s %10.2f ms\n", "find(view)", view_ms);
+}
+
+}  // namespace
+
+int main() {
+  bench_iteration();
+  bench_orders();
+  bench_rebuild();
+  bench_bulk_load();
+  bench_range_scan();
+  bench_string_keys();
+}
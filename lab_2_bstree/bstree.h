@@ -1,15 +1,37 @@
 #ifndef BSTREE_H_
 #define BSTREE_H_
 
+#include <exception>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <queue>
-
-template <typename T_key, typename T_data>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "../lab_1_list/slab_allocator.h"
+#include "key_compare.h"
+
+/// Двоичное дерево поиска. Узлы выделяются аллокатором Alloc. С slab_allocator
+/// (см. PooledBst) узлы нарезаются из непрерывных блоков, удалённые узлы
+/// переиспользуются, а очистка дерева с тривиально разрушаемыми ключами и
+/// данными освобождает блоки целиком, не обходя узлы.
+///
+/// Ключи упорядочивает Compare (по умолчанию прозрачный std::less<>). Если
+/// у компаратора есть трёхстороннее сравнение compare (three_way_less), на
+/// каждый узел при поиске приходится одно сравнение вместо двух. Способ
+/// спуска задаёт key_search_policy: ключи арифметических типов ищутся без
+/// ветвлений
+template <typename T_key, typename T_data,
+          typename Alloc = std::allocator<std::pair<const T_key, T_data>>,
+          typename Compare = std::less<>>
 class Bst {
   class BstIterator;
   class ReverseBstIterator;
+  class BstRange;
   struct Node;
 
  public:
@@ -19,22 +41,92 @@ class Bst {
   using const_reference = value_type const &;
   using iterator = BstIterator;
   using reverse_iterator = ReverseBstIterator;
+  using range_view = BstRange;
   using size_type = std::size_t;
+  using allocator_type = Alloc;
+  using key_compare = Compare;
 
  public:
-  Bst(){};
-  Bst(Bst const &b);
-  ~Bst() { delete root_; };
+  Bst() : Bst(allocator_type()){};
+  explicit Bst(allocator_type const &a) : alloc_(a){};
+  explicit Bst(key_compare const &comp,
+               allocator_type const &a = allocator_type())
+      : alloc_(a), comp_(comp){};
+  Bst(Bst const &b);  // полная копия дерева, O(n)
+  Bst(Bst &&b);
+  ~Bst() { clear(); };
+
+  Bst &operator=(Bst const &b);
+  Bst &operator=(Bst &&b);
+
+  /// Построение идеально сбалансированного дерева за O(n) из диапазона
+  /// пар (ключ, данные), упорядоченного по строго возрастающим ключам.
+  /// Иначе бросает std::invalid_argument
+  template <typename ForwardIt>
+  static Bst from_sorted(ForwardIt first, ForwardIt last);
+
+  /// То же, но левое и правое поддеревья верхних уровней строятся в
+  /// отдельных потоках. Пул узлов не разделяется между потоками, поэтому с
+  /// аллокатором, имеющим состояние (slab_allocator), и для небольших
+  /// диапазонов построение однопоточное
+  template <typename ForwardIt>
+  static Bst parallel_from_sorted(
+      ForwardIt first, ForwardIt last,
+      size_type threads = std::thread::hardware_concurrency());
+
+  void swap(Bst &other);  // обмен содержимым
 
   size_type size() const;       // размер дерева
   void clear();                 // очистка дерева
   bool empty() const noexcept;  // проверка дерева на пустоту
 
-  reference at(key_type k);  // доступ по чтению/записи к данным по ключу
-  const reference at(key_type k) const;
-
-  void insert(key_type k, value_type v);  // включение данных с заданным ключом
-  void remove(key_type k);  // удаление данных с заданным ключом
+  // Поиск принимает ключ любого типа K. Прозрачному компаратору (как
+  // std::less<> по умолчанию) он передаётся как есть: например,
+  // std::string_view или строковый литерал при ключах std::string, без
+  // временного key_type. Для остальных компараторов из k строится key_type
+
+  // доступ по чтению/записи к данным по ключу
+  template <typename K = key_type>
+  reference at(K const &k);
+  template <typename K = key_type>
+  const reference at(K const &k) const;
+
+  // включение данных с заданным ключом
+  void insert(key_type const &k, value_type const &v);
+  void remove(key_type const &k);  // удаление данных с заданным ключом
+
+  // Включение, если ключа k ещё нет: данные строятся на месте из args.
+  // Иначе дерево не меняется, и args не используются. second – было ли
+  // включение
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type const &k, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&k, Args &&...args);
+  // включение или замена данных; second – было ли включение
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type const &k, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&k, M &&obj);
+  // Узел строится из args до поиска: ключ – из первого аргумента, данные –
+  // из остальных. Если ключ уже есть, узел уничтожается
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+
+  // поиск по ключу: итератор на элемент или end()
+  template <typename K = key_type>
+  iterator find(K const &k) noexcept;
+  // первый элемент с ключом не меньше k и первый с ключом больше k
+  template <typename K = key_type>
+  iterator lower_bound(K const &k) noexcept;
+  template <typename K = key_type>
+  iterator upper_bound(K const &k) noexcept;
+  // элементы с ключом k: пустой диапазон или один элемент
+  template <typename K = key_type>
+  std::pair<iterator, iterator> equal_range(K const &k) noexcept;
+  // элементы с ключами из полуинтервала [lo, hi). Трудоёмкость обхода –
+  // O (log n + m), где m – число элементов в диапазоне
+  template <typename K = key_type>
+  range_view range(K const &lo, K const &hi) noexcept;
 
   //формирование списка ключей в дереве в порядке обхода узлов по схеме,
   //заданной в варианте задания
@@ -56,25 +148,81 @@ class Bst {
   //запрос «неустановленного» обратного итератора
   reverse_iterator rend() noexcept;
 
+  allocator_type get_allocator() const;
+  key_compare key_comp() const;
+
  private:
   struct Node {
     key_type key;
     value_type data;
     Node *left = nullptr;
     Node *right = nullptr;
+    // Родитель нужен итераторам: переход к соседнему узлу идёт вверх по
+    // дереву, а не поиском от корня
+    Node *parent = nullptr;
 
-    Node(key_type k, value_type v) : key(k), data(v) {}
-    ~Node() {
-      delete left;
-      delete right;
-    }
+    template <typename K, typename... Args>
+    explicit Node(K &&k, Args &&...args)
+        : key(std::forward<K>(k)), data(std::forward<Args>(args)...) {}
   };
 
-  void insert(key_type k, value_type v, Node *&node);
-  Node *remove(key_type k, Node *node);
-  Node *find(key_type k, Node *node);
-  Node *find_min(Node *node);
-  Node *find_max(Node *node);
+  static constexpr key_search search_policy =
+      key_search_policy<key_type, key_compare>::value;
+
+  template <typename K>
+  static decltype(auto) lookup_key(K const &k);
+
+  // Все операции итеративны: глубина вырожденного дерева равна n, и
+  // рекурсия по нему переполнила бы стек
+  template <typename K>
+  Node *find_node(K const &k) const;
+  template <typename K>
+  Node *lower_node(K const &k) const;
+  template <typename K>
+  Node *upper_node(K const &k) const;
+  // Место ключа k: поле, в котором лежит узел с ключом k или в которое
+  // его нужно подвесить; parent – узел, которому принадлежит это поле
+  Node **find_link(key_type const &k, Node *&parent);
+  iterator attach_node(Node **link, Node *parent, Node *node) noexcept;
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&k, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign_key(K &&k, M &&obj);
+  Node *find_min(Node *node) const;
+  Node *find_max(Node *node) const;
+  void transplant(Node *u, Node *v);
+  void destroy(Node *node);
+  Node *clone(Node const *node);
+
+  using node_allocator = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  template <typename... Args>
+  Node *create_node(Args &&...args);
+  void free_node(Node *node) noexcept;
+  bool release_nodes() noexcept;
+
+  // Диапазоны короче порога parallel_from_sorted строит в одном потоке
+  static constexpr size_type parallel_build_threshold = 1 << 15;
+
+  template <typename ForwardIt>
+  void check_sorted(ForwardIt first, ForwardIt last) const;
+  template <typename ForwardIt>
+  Node *build_sorted(ForwardIt &it, size_type n);
+  template <typename ForwardIt>
+  Node *parallel_build_sorted(ForwardIt first, size_type n, size_type threads);
+  Node *link_sorted(Node *node, Node *left, Node *right) noexcept;
+
+  // Есть ли у аллокатора освобождение всего пула разом (slab_allocator)
+  template <typename A, typename = void>
+  struct has_release : std::false_type {};
+  template <typename A>
+  struct has_release<A, std::void_t<decltype(std::declval<A &>().release())>>
+      : std::true_type {};
+
+  node_allocator alloc_;
+  key_compare comp_;
 
   size_type size_ = 0;
   Node *root_ = nullptr;
@@ -89,6 +237,7 @@ class Bst {
     ~BstIterator(){};
 
     reference operator*() const noexcept { return current_->data; }
+    key_type const &key() const noexcept { return current_->key; }
 
     BstIterator &operator++() noexcept {
       current_ = find_next(current_);
@@ -102,12 +251,18 @@ class Bst {
     }
 
     BstIterator &operator--() noexcept {
-      current_ = find_prev(current_);
+      // Шаг назад от end() ведёт к наибольшему ключу
+      if (current_ == nullptr) {
+        current_ = bst_root_;
+        while (current_ && current_->right) current_ = current_->right;
+      } else {
+        current_ = find_prev(current_);
+      }
       return *this;
     }
     BstIterator operator--(int) noexcept {
       auto it = *this;
-      (*this);
+      --(*this);
       return it;
     }
 
@@ -119,49 +274,36 @@ class Bst {
     }
 
    private:
-    Node *find_parent(Node *node) { return find_parent(node, bst_root_); }
-    Node *find_parent(Node *node, Node *from) {
-      if (from == nullptr || node == nullptr) return nullptr;
-      if (from->left == node || from->right == node) return from;
-
-      if (node->key > from->key) {
-        return find_parent(node, from->right);
-      } else if (node->key < from->key) {
-        return find_parent(node, from->left);
-      }
-      return nullptr;
-    }
-
+    // Переход к соседнему узлу: спуск в поддерево или подъём по родителям.
+    // Полный обход проходит каждое ребро дважды, т.е. O(1) в среднем на шаг
     Node *find_next(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->right != nullptr) {
         node = node->right;
         while (node->left) node = node->left;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->left == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->right == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
 
     Node *find_prev(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->left != nullptr) {
         node = node->left;
         while (node->right) node = node->right;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->right == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->left == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
@@ -176,6 +318,7 @@ class Bst {
     ~ReverseBstIterator(){};
 
     reference operator*() const noexcept { return current_->data; }
+    key_type const &key() const noexcept { return current_->key; }
 
     ReverseBstIterator &operator++() noexcept {
       current_ = find_prev(current_);
@@ -188,12 +331,18 @@ class Bst {
     }
 
     ReverseBstIterator &operator--() noexcept {
-      current_ = find_next(current_);
+      // Шаг назад от rend() ведёт к наименьшему ключу
+      if (current_ == nullptr) {
+        current_ = bst_root_;
+        while (current_ && current_->left) current_ = current_->left;
+      } else {
+        current_ = find_next(current_);
+      }
       return *this;
     }
     ReverseBstIterator operator--(int) noexcept {
       auto it = *this;
-      (*this);
+      --(*this);
       return it;
     }
 
@@ -205,76 +354,161 @@ class Bst {
     }
 
    private:
-    Node *find_parent(Node *node) { return find_parent(node, bst_root_); }
-    Node *find_parent(Node *node, Node *from) {
-      if (from == nullptr || node == nullptr) return nullptr;
-      if (from->left == node || from->right == node) return from;
-
-      if (node->key > from->key) {
-        return find_parent(node, from->right);
-      } else if (node->key < from->key) {
-        return find_parent(node, from->left);
-      }
-      return nullptr;
-    }
-
+    // Переход к соседнему узлу: спуск в поддерево или подъём по родителям.
+    // Полный обход проходит каждое ребро дважды, т.е. O(1) в среднем на шаг
     Node *find_next(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->right != nullptr) {
         node = node->right;
         while (node->left) node = node->left;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->left == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->right == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
 
     Node *find_prev(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->left != nullptr) {
         node = node->left;
         while (node->right) node = node->right;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->right == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->left == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
   };
+
+  // Диапазон [first, last) для цикла for по диапазону
+  class BstRange {
+   private:
+    iterator first_;
+    iterator last_;
+
+   public:
+    BstRange(iterator first, iterator last) : first_(first), last_(last){};
+
+    iterator begin() const noexcept { return first_; }
+    iterator end() const noexcept { return last_; }
+    bool empty() const noexcept { return first_ == last_; }
+  };
 };
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::insert(key_type k, value_type v) {
-  insert(k, v, root_);
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::insert(key_type const &k,
+                                                value_type const &v) {
+  insert_or_assign(k, v);
 }
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::insert(key_type k, value_type v, Node *&node) {
-  if (node == nullptr) {
-    node = new Node(k, v);
-  } else if (k > node->key) {
-    insert(k, v, node->right);
-  } else if (k < node->key) {
-    insert(k, v, node->left);
-  } else {  // if equal
-    node->data = v;
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename... Args>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::try_emplace(
+    key_type const &k, Args &&...args) {
+  return try_emplace_key(k, std::forward<Args>(args)...);
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename... Args>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::try_emplace(key_type &&k, Args &&...args) {
+  return try_emplace_key(std::move(k), std::forward<Args>(args)...);
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename M>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::insert_or_assign(
+    key_type const &k, M &&obj) {
+  return insert_or_assign_key(k, std::forward<M>(obj));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename M>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::insert_or_assign(key_type &&k, M &&obj) {
+  return insert_or_assign_key(std::move(k), std::forward<M>(obj));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename... Args>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::emplace(Args &&...args) {
+  Node *node = create_node(std::forward<Args>(args)...);
+  Node *parent;
+  Node **link = find_link(node->key, parent);
+  if (*link != nullptr) {
+    free_node(node);
+    return {BstIterator(root_, *link), false};
+  }
+  return {attach_node(link, parent, node), true};
+}
+
+// Ключ передаётся в узел, только если его ещё нет в дереве; поиск идёт по
+// ссылке на исходный ключ
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K, typename... Args>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::try_emplace_key(K &&k, Args &&...args) {
+  Node *parent;
+  Node **link = find_link(k, parent);
+  if (*link != nullptr) return {BstIterator(root_, *link), false};
+  Node *node = create_node(std::forward<K>(k), std::forward<Args>(args)...);
+  return {attach_node(link, parent, node), true};
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K, typename M>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator, bool>
+Bst<T_key, T_data, Alloc, Compare>::insert_or_assign_key(K &&k, M &&obj) {
+  Node *parent;
+  Node **link = find_link(k, parent);
+  if (*link != nullptr) {
+    (*link)->data = std::forward<M>(obj);
+    return {BstIterator(root_, *link), false};
+  }
+  Node *node = create_node(std::forward<K>(k), std::forward<M>(obj));
+  return {attach_node(link, parent, node), true};
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::Node **
+Bst<T_key, T_data, Alloc, Compare>::find_link(
+    key_type const &k, Node *&parent) {
+  parent = nullptr;
+  Node **link = &root_;
+  while (*link != nullptr) {
+    int c = three_way(comp_, k, (*link)->key);
+    if (c == 0) break;
+    parent = *link;
+    link = c < 0 ? &parent->left : &parent->right;
   }
+  return link;
+}
+
+// Подвешивание нового узла в поле link, найденное find_link
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::attach_node(Node **link, Node *parent,
+                                                Node *node) noexcept {
+  *link = node;
+  node->parent = parent;
   size_++;
+  return BstIterator(root_, node);
 }
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::bf_print() const noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::bf_print() const noexcept {
   if (root_ == nullptr) return;
 
   std::queue<Node *> q;
@@ -291,143 +525,552 @@ void Bst<T_key, T_data>::bf_print() const noexcept {
   std::cout << std::endl;
 }
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::df_print() const noexcept {}
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::df_print() const noexcept {}
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::size_type Bst<T_key, T_data>::size() const {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::size_type
+Bst<T_key, T_data, Alloc, Compare>::size() const {
   return size_;
 }
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::clear() {
-  delete root_;
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::clear() {
+  if (!release_nodes()) destroy(root_);
+  root_ = nullptr;
+  size_ = 0;
 }
 
-template <typename T_key, typename T_data>
-bool Bst<T_key, T_data>::empty() const noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+bool Bst<T_key, T_data, Alloc, Compare>::empty() const noexcept {
   return size_ == 0;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::reference Bst<T_key, T_data>::at(key_type k) {
-  return find(k, root_)->data;
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::reference
+Bst<T_key, T_data, Alloc, Compare>::at(K const &k) {
+  Node *node = find_node(lookup_key(k));
+  if (node == nullptr) throw std::out_of_range("Bst::at");
+  return node->data;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::reference Bst<T_key, T_data>::at(
-    key_type k) const {
-  return find(k, root_)->data;
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::reference
+Bst<T_key, T_data, Alloc, Compare>::at(K const &k) const {
+  Node *node = find_node(lookup_key(k));
+  if (node == nullptr) throw std::out_of_range("Bst::at");
+  return node->data;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::Node *Bst<T_key, T_data>::find(key_type k,
-                                                            Node *node) {
-  if (node == nullptr) {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::find_node(K const &k) const {
+  if constexpr (search_policy == key_search::branchless) {
+    // Спуск до самого низа без ветвлений, совпадение проверяется один раз
+    Node *found = lower_node(k);
+    if (found != nullptr && comp_(k, found->key)) return nullptr;
+    return found;
+  } else {
+    Node *node = root_;
+    while (node != nullptr) {
+      int c = three_way(comp_, k, node->key);
+      if (c < 0) {
+        node = node->left;
+      } else if (c > 0) {
+        node = node->right;
+      } else {  // equal
+        return node;
+      }
+    }
     return nullptr;
-  } else if (k > node->key) {
-    return find(k, node->right);
-  } else if (k < node->key) {
-    return find(k, node->left);
-  } else {  // equal
-    return node;
   }
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::size_type Bst<T_key, T_data>::height()
-    const noexcept {
-  std::function<size_type(Node *)> lamd_height = [&lamd_height](Node *node) {
-    if (node == nullptr) {
-      return (size_type)0;
+// Первый узел с ключом не меньше k
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::lower_node(K const &k) const {
+  Node *node = root_;
+  Node *found = nullptr;
+  while (node != nullptr) {
+    bool less = comp_(node->key, k);
+    if constexpr (search_policy == key_search::branchless) {
+      // Сын выбирается индексом, а не переходом: исход сравнения
+      // становится данными, и предсказывать его процессору не нужно
+      Node *const next[2] = {node->left, node->right};
+      found = less ? found : node;
+      node = next[less];
+    } else if (less) {
+      node = node->right;
     } else {
-      return (size_type)(1 + std::max(lamd_height(node->left),
-                                      lamd_height(node->right)));
+      found = node;
+      node = node->left;
     }
-  };
-  return lamd_height(root_);
+  }
+  return found;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::Node *Bst<T_key, T_data>::find_min(Node *node) {
-  if (node == nullptr) {
-    return nullptr;
-  } else if (node->left == nullptr) {
-    return node;
-  } else {
-    return find_min(node->left);
+// Первый узел с ключом больше k
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::upper_node(K const &k) const {
+  Node *node = root_;
+  Node *found = nullptr;
+  while (node != nullptr) {
+    bool greater = comp_(k, node->key);
+    if constexpr (search_policy == key_search::branchless) {
+      Node *const next[2] = {node->right, node->left};
+      found = greater ? node : found;
+      node = next[greater];
+    } else if (greater) {
+      found = node;
+      node = node->left;
+    } else {
+      node = node->right;
+    }
   }
+  return found;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::Node *Bst<T_key, T_data>::find_max(Node *node) {
-  if (node == nullptr) {
-    return nullptr;
-  } else if (node->right == nullptr) {
-    return node;
+// Ключ другого типа передаётся непрозрачному компаратору после
+// преобразования в key_type
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+decltype(auto) Bst<T_key, T_data, Alloc, Compare>::lookup_key(K const &k) {
+  if constexpr (std::is_same_v<K, key_type> ||
+                is_transparent<key_compare>::value) {
+    return (k);
   } else {
-    return find_max(node->right);
+    return key_type(k);
   }
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::iterator Bst<T_key, T_data>::begin() noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::find(K const &k) noexcept {
+  return BstIterator(root_, find_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::lower_bound(K const &k) noexcept {
+  return BstIterator(root_, lower_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::upper_bound(K const &k) noexcept {
+  return BstIterator(root_, upper_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+std::pair<typename Bst<T_key, T_data, Alloc, Compare>::iterator,
+          typename Bst<T_key, T_data, Alloc, Compare>::iterator>
+Bst<T_key, T_data, Alloc, Compare>::equal_range(K const &k) noexcept {
+  // Ключи уникальны, поэтому хватает одного спуска
+  auto const &key = lookup_key(k);
+  Node *lower = lower_node(key);
+  iterator first(root_, lower);
+  iterator last = first;
+  if (lower != nullptr && !comp_(key, lower->key)) ++last;
+  return {first, last};
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename K>
+typename Bst<T_key, T_data, Alloc, Compare>::range_view
+Bst<T_key, T_data, Alloc, Compare>::range(K const &lo, K const &hi) noexcept {
+  iterator first = lower_bound(lo);
+  if (!comp_(lookup_key(lo), lookup_key(hi))) return BstRange(first, first);
+  return BstRange(first, lower_bound(hi));
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::size_type
+Bst<T_key, T_data, Alloc, Compare>::height() const noexcept {
+  // Обход в ширину по уровням
+  size_type levels = 0;
+  std::queue<Node *> q;
+  if (root_ != nullptr) q.push(root_);
+
+  while (!q.empty()) {
+    for (size_type i = q.size(); i > 0; i--) {
+      Node *node = q.front();
+      q.pop();
+      if (node->left) q.push(node->left);
+      if (node->right) q.push(node->right);
+    }
+    levels++;
+  }
+  return levels;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::find_min(Node *node) const {
+  if (node == nullptr) return nullptr;
+  while (node->left != nullptr) node = node->left;
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::find_max(Node *node) const {
+  if (node == nullptr) return nullptr;
+  while (node->right != nullptr) node = node->right;
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::begin() noexcept {
   return BstIterator(root_, find_min(root_));
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::iterator Bst<T_key, T_data>::end() noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::iterator
+Bst<T_key, T_data, Alloc, Compare>::end() noexcept {
   return BstIterator(root_, nullptr);
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::reverse_iterator
-Bst<T_key, T_data>::rbegin() noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::reverse_iterator
+Bst<T_key, T_data, Alloc, Compare>::rbegin() noexcept {
   return ReverseBstIterator(root_, find_max(root_));
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::reverse_iterator
-Bst<T_key, T_data>::rend() noexcept {
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::reverse_iterator
+Bst<T_key, T_data, Alloc, Compare>::rend() noexcept {
   return ReverseBstIterator(root_, nullptr);
 }
 
-template <typename T_key, typename T_data>
-void Bst<T_key, T_data>::remove(key_type k) {
-  remove(k, root_);
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::remove(key_type const &k) {
+  Node *node = find_node(k);
+  if (node == nullptr) return;
+
+  if (node->left == nullptr) {
+    transplant(node, node->right);
+  } else if (node->right == nullptr) {
+    transplant(node, node->left);
+  } else {
+    // Узел заменяется своим преемником; узлы не копируются, поэтому
+    // итераторы на остальные элементы остаются действительными
+    Node *next = find_min(node->right);
+    if (next->parent != node) {
+      transplant(next, next->right);
+      next->right = node->right;
+      next->right->parent = next;
+    }
+    transplant(node, next);
+    next->left = node->left;
+    next->left->parent = next;
+  }
+
+  free_node(node);
+  size_--;
 }
 
-template <typename T_key, typename T_data>
-typename Bst<T_key, T_data>::Node *Bst<T_key, T_data>::remove(key_type k,
-                                                              Node *node) {
-  if (node == nullptr) return nullptr;
-  
-  if (k < node->key) {
-    node->left = remove(k, node->left);
-  } else if (k > node->key) {
-    node->right = remove(k, node->right);
+// Замена поддерева u поддеревом v в родителе u
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::transplant(Node *u, Node *v) {
+  if (u->parent == nullptr) {
+    root_ = v;
+  } else if (u == u->parent->left) {
+    u->parent->left = v;
   } else {
-    if (node->left == nullptr) {
-      Node *right_node = node->right;
-      node->right = node->left = nullptr;
-      delete node;
-      return right_node;
+    u->parent->right = v;
+  }
+  if (v != nullptr) v->parent = u->parent;
+}
+
+// Разрушение поддерева без рекурсии: левый сын поворотом поднимается на
+// место узла, пока левых сыновей не останется; узел без левого сына
+// удаляется, и обход продолжается с правого. Каждое ребро проходится не
+// более двух раз, стек не растёт
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::destroy(Node *node) {
+  while (node != nullptr) {
+    if (node->left != nullptr) {
+      Node *left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    } else {
+      Node *right = node->right;
+      free_node(node);
+      node = right;
     }
+  }
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::allocator_type
+Bst<T_key, T_data, Alloc, Compare>::get_allocator() const {
+  return allocator_type(alloc_);
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::key_compare
+Bst<T_key, T_data, Alloc, Compare>::key_comp() const {
+  return comp_;
+}
 
-    if (node->right == nullptr) {
-      Node *left_child = node->left;
-      node->right = node->left = nullptr;
-      delete node;
-      return left_child;
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename... Args>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::create_node(Args &&...args) {
+  Node *node = node_traits::allocate(alloc_, 1);
+  try {
+    node_traits::construct(alloc_, node, std::forward<Args>(args)...);
+  } catch (...) {
+    node_traits::deallocate(alloc_, node, 1);
+    throw;
+  }
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::free_node(Node *node) noexcept {
+  node_traits::destroy(alloc_, node);
+  node_traits::deallocate(alloc_, node, 1);
+}
+
+// Если пул можно освободить целиком, а узлы не требуют вызова деструктора,
+// дерево не обходится
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+bool Bst<T_key, T_data, Alloc, Compare>::release_nodes() noexcept {
+  if constexpr (std::is_trivially_destructible_v<Node> &&
+                has_release<node_allocator>::value) {
+    return alloc_.release();
+  }
+  return false;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+Bst<T_key, T_data, Alloc, Compare>::Bst(Bst const &b)
+    : alloc_(node_traits::select_on_container_copy_construction(b.alloc_)),
+      comp_(b.comp_) {
+  root_ = clone(b.root_);
+  size_ = b.size_;
+}
+
+// Копия поддерева той же формы за O(n). Обход идёт по ссылкам на родителей
+// в обоих деревьях сразу, поэтому стек не нужен. При исключении уже
+// скопированные узлы освобождаются
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::clone(Node const *node) {
+  if (node == nullptr) return nullptr;
+
+  auto copy = [this](Node const *from, Node *parent) {
+    Node *to = create_node(from->key, from->data);
+    to->parent = parent;
+    return to;
+  };
+
+  Node *top = copy(node, nullptr);
+  try {
+    Node const *from = node;
+    Node *to = top;
+    while (true) {
+      if (from->left != nullptr && to->left == nullptr) {
+        to->left = copy(from->left, to);
+        from = from->left;
+        to = to->left;
+      } else if (from->right != nullptr && to->right == nullptr) {
+        to->right = copy(from->right, to);
+        from = from->right;
+        to = to->right;
+      } else if (from == node) {
+        break;
+      } else {
+        from = from->parent;
+        to = to->parent;
+      }
+    }
+  } catch (...) {
+    destroy(top);
+    throw;
+  }
+  return top;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+Bst<T_key, T_data, Alloc, Compare>::Bst(Bst &&b) : Bst() {
+  swap(b);
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+Bst<T_key, T_data, Alloc, Compare> &
+Bst<T_key, T_data, Alloc, Compare>::operator=(Bst const &b) {
+  if (this != &b) {
+    Bst(b).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+Bst<T_key, T_data, Alloc, Compare> &
+Bst<T_key, T_data, Alloc, Compare>::operator=(Bst &&b) {
+  if (this != &b) {
+    Bst(std::move(b)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+void Bst<T_key, T_data, Alloc, Compare>::swap(Bst &other) {
+  std::swap(root_, other.root_);
+  std::swap(size_, other.size_);
+  std::swap(comp_, other.comp_);
+  if constexpr (node_traits::propagate_on_container_swap::value) {
+    std::swap(alloc_, other.alloc_);
+  }
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename ForwardIt>
+Bst<T_key, T_data, Alloc, Compare>
+Bst<T_key, T_data, Alloc, Compare>::from_sorted(
+    ForwardIt first, ForwardIt last) {
+  Bst tree;
+  tree.check_sorted(first, last);
+  auto n = static_cast<size_type>(std::distance(first, last));
+  tree.root_ = tree.build_sorted(first, n);
+  tree.size_ = n;
+  return tree;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename ForwardIt>
+Bst<T_key, T_data, Alloc, Compare>
+Bst<T_key, T_data, Alloc, Compare>::parallel_from_sorted(
+    ForwardIt first, ForwardIt last, size_type threads) {
+  Bst tree;
+  tree.check_sorted(first, last);
+  auto n = static_cast<size_type>(std::distance(first, last));
+  if (!node_traits::is_always_equal::value) threads = 1;
+  tree.root_ = tree.parallel_build_sorted(first, n, threads);
+  tree.size_ = n;
+  return tree;
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename ForwardIt>
+void Bst<T_key, T_data, Alloc, Compare>::check_sorted(
+    ForwardIt first, ForwardIt last) const {
+  if (first == last) return;
+  for (ForwardIt next = std::next(first); next != last; first = next++) {
+    if (!comp_(first->first, next->first)) {
+      throw std::invalid_argument(
+          "Bst::from_sorted: keys are not increasing");
     }
+  }
+}
+
+// Построение поддерева из n очередных элементов: сначала левая половина,
+// затем корень, затем правая, так что диапазон читается один раз по
+// порядку. Глубина рекурсии — высота дерева, т.е. O(log n). При исключении
+// уже созданные узлы поддерева освобождаются
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename ForwardIt>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::build_sorted(ForwardIt &it, size_type n) {
+  if (n == 0) return nullptr;
+
+  size_type left_size = (n - 1) / 2;
+  Node *left = build_sorted(it, left_size);
+  Node *node;
+  try {
+    node = create_node(it->first, it->second);
+    ++it;
+  } catch (...) {
+    destroy(left);
+    throw;
+  }
+
+  Node *right;
+  try {
+    right = build_sorted(it, n - 1 - left_size);
+  } catch (...) {
+    destroy(left);
+    free_node(node);
+    throw;
+  }
+  return link_sorted(node, left, right);
+}
 
-    Node *min_node = find_min(node->right);
-    node->key = min_node->key;
-    node->data = min_node->data;
-    node->right = remove(min_node->key, node->right);
+// Левое поддерево строит новый поток, корень и правое — текущий; потоки
+// делятся поровну между половинами
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+template <typename ForwardIt>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::parallel_build_sorted(
+    ForwardIt first, size_type n, size_type threads) {
+  if (threads < 2 || n < parallel_build_threshold) {
+    return build_sorted(first, n);
   }
 
+  size_type left_size = (n - 1) / 2;
+  ForwardIt middle = std::next(first, static_cast<std::ptrdiff_t>(left_size));
+
+  Node *left = nullptr;
+  std::exception_ptr left_error;
+  std::thread worker([&] {
+    try {
+      left = parallel_build_sorted(first, left_size, threads / 2);
+    } catch (...) {
+      left_error = std::current_exception();
+    }
+  });
+
+  Node *node = nullptr;
+  Node *right = nullptr;
+  try {
+    node = create_node(middle->first, middle->second);
+    right = parallel_build_sorted(std::next(middle), n - 1 - left_size,
+                                  threads - threads / 2);
+  } catch (...) {
+    worker.join();
+    destroy(left);
+    if (node != nullptr) free_node(node);
+    throw;
+  }
+
+  worker.join();
+  if (left_error) {
+    destroy(right);
+    free_node(node);
+    std::rethrow_exception(left_error);
+  }
+
+  return link_sorted(node, left, right);
+}
+
+template <typename T_key, typename T_data, typename Alloc, typename Compare>
+typename Bst<T_key, T_data, Alloc, Compare>::Node *
+Bst<T_key, T_data, Alloc, Compare>::link_sorted(
+    Node *node, Node *left, Node *right) noexcept {
+  node->left = left;
+  if (left != nullptr) left->parent = node;
+  node->right = right;
+  if (right != nullptr) right->parent = node;
   return node;
 }
 
+template <typename T_key, typename T_data>
+using PooledBst =
+    Bst<T_key, T_data, slab_allocator<std::pair<const T_key, T_data>>>;
+
 #endif  // BSTREE_H_
\ No newline at end of file
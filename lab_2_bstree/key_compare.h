@@ -0,0 +1,95 @@
+#ifndef KEY_COMPARE_H_
+#define KEY_COMPARE_H_
+
+#include <type_traits>
+#include <utility>
+
+/// Есть ли у компаратора трёхстороннее сравнение compare(a, b): результат
+/// меньше нуля, ноль или больше нуля, как у std::string::compare
+template <typename Compare, typename A, typename B, typename = void>
+struct has_three_way : std::false_type {};
+template <typename Compare, typename A, typename B>
+struct has_three_way<
+    Compare, A, B,
+    std::void_t<decltype(std::declval<Compare const &>().compare(
+        std::declval<A const &>(), std::declval<B const &>()))>>
+    : std::true_type {};
+
+/// Прозрачен ли компаратор (std::less<>): ключ другого типа передаётся ему
+/// без преобразования в тип ключа дерева
+template <typename Compare, typename = void>
+struct is_transparent : std::false_type {};
+template <typename Compare>
+struct is_transparent<Compare, std::void_t<typename Compare::is_transparent>>
+    : std::true_type {};
+
+/// Сравнение a и b: -1, 0 или 1. Трёхсторонний компаратор вызывается
+/// один раз, обычный — дважды
+template <typename Compare, typename A, typename B>
+int three_way(Compare const &comp, A const &a, B const &b) {
+  if constexpr (has_three_way<Compare, A, B>::value) {
+    auto c = comp.compare(a, b);
+    return (c > 0) - (c < 0);
+  } else {
+    if (comp(a, b)) return -1;
+    return comp(b, a) ? 1 : 0;
+  }
+}
+
+/// Прозрачный компаратор с трёхсторонним сравнением. Типы с методом
+/// compare (std::string, std::string_view) сравниваются одним проходом,
+/// остальные — выражением (b < a) - (a < b) без ветвлений
+struct three_way_less {
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(A const &a, B const &b) const {
+    return a < b;
+  }
+
+  template <typename A, typename B>
+  int compare(A const &a, B const &b) const {
+    if constexpr (has_member_compare<A, B>::value) {
+      return a.compare(b);
+    } else {
+      return static_cast<int>(b < a) - static_cast<int>(a < b);
+    }
+  }
+
+ private:
+  template <typename A, typename B, typename = void>
+  struct has_member_compare : std::false_type {};
+  template <typename A, typename B>
+  struct has_member_compare<
+      A, B,
+      std::void_t<decltype(std::declval<A const &>().compare(
+          std::declval<B const &>()))>> : std::true_type {};
+};
+
+/// Способ спуска по дереву при поиске ключа
+enum class key_search {
+  // два вызова компаратора на узел, выход на совпавшем ключе
+  two_way,
+  // один вызов compare на узел, выход на совпавшем ключе
+  three_way,
+  // один вызов компаратора на узел до самого низа: сын выбирается
+  // условной пересылкой, без ветвления, а совпадение проверяется один раз
+  // в конце. Выгоден для дешёвых сравнений, исход которых процессор не
+  // может предсказать
+  branchless,
+};
+
+/// Политика поиска для ключа Key и компаратора Compare, выбирается при
+/// компиляции. Трёхсторонний компаратор используется всегда, ключи
+/// арифметических типов ищутся без ветвлений, остальные — двумя
+/// сравнениями. Для своих типов политику можно задать специализацией
+template <typename Key, typename Compare, typename = void>
+struct key_search_policy
+    : std::integral_constant<
+          key_search, has_three_way<Compare, Key, Key>::value
+                          ? key_search::three_way
+                          : std::is_arithmetic_v<Key> ? key_search::branchless
+                                                      : key_search::two_way> {
+};
+
+#endif  // KEY_COMPARE_H_
@@ -2,14 +2,43 @@
 #define BSTREE_H_
 
 #include <algorithm>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <queue>
-
-template <typename T_key, typename T_data>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../lab_1_list/slab_allocator.h"
+#include "../lab_2_bstree/key_compare.h"
+
+/// АВЛ-дерево. Узлы выделяются аллокатором Alloc. С slab_allocator
+/// (см. PooledAvlBst) узлы нарезаются из непрерывных блоков, удалённые узлы
+/// переиспользуются, а очистка дерева с тривиально разрушаемыми ключами и
+/// данными освобождает блоки целиком, не обходя узлы.
+///
+/// При Ranked = true (см. RankedAvlBst) узел хранит размер своего
+/// поддерева, и порядковые запросы select, rank и count_range выполняются
+/// за O(log n). Вставка и удаление тогда обновляют размеры на всём пути до
+/// корня.
+///
+/// Ключи упорядочивает Compare, как в Bst: с трёхсторонним компаратором
+/// (three_way_less) поиск делает одно сравнение на узел, а ключи
+/// арифметических типов по умолчанию ищутся без ветвлений
+/// (key_search_policy)
+template <typename T_key, typename T_data,
+          typename Alloc = std::allocator<std::pair<const T_key, T_data>>,
+          bool Ranked = false, typename Compare = std::less<>>
 class AvlBst {
   class BstIterator;
   class ReverseBstIterator;
+  class BstRange;
   struct Node;
 
  public:
@@ -19,22 +48,128 @@ class AvlBst {
   using const_reference = value_type const &;
   using iterator = BstIterator;
   using reverse_iterator = ReverseBstIterator;
+  using range_view = BstRange;
   using size_type = std::size_t;
+  using allocator_type = Alloc;
+  using key_compare = Compare;
 
  public:
-  AvlBst(){};
-  AvlBst(AvlBst const &b);
-  ~AvlBst() { delete root_; };
+  AvlBst() : AvlBst(allocator_type()){};
+  explicit AvlBst(allocator_type const &a) : alloc_(a){};
+  explicit AvlBst(key_compare const &comp,
+                  allocator_type const &a = allocator_type())
+      : alloc_(a), comp_(comp){};
+  AvlBst(AvlBst const &b);  // полная копия дерева, O(n)
+  AvlBst(AvlBst &&b);
+  ~AvlBst() { clear(); };
+
+  AvlBst &operator=(AvlBst const &b);
+  AvlBst &operator=(AvlBst &&b);
+
+  /// Построение идеально сбалансированного дерева за O(n) из диапазона
+  /// пар (ключ, данные), упорядоченного по строго возрастающим ключам.
+  /// Иначе бросает std::invalid_argument
+  template <typename ForwardIt>
+  static AvlBst from_sorted(ForwardIt first, ForwardIt last);
+
+  /// То же, но левое и правое поддеревья верхних уровней строятся в
+  /// отдельных потоках. Пул узлов не разделяется между потоками, поэтому с
+  /// аллокатором, имеющим состояние (slab_allocator), и для небольших
+  /// диапазонов построение однопоточное
+  template <typename ForwardIt>
+  static AvlBst parallel_from_sorted(
+      ForwardIt first, ForwardIt last,
+      size_type threads = std::thread::hardware_concurrency());
+
+  void swap(AvlBst &other);  // обмен содержимым
+
+  /// Разделение: в дереве остаются ключи меньше k, ключи не меньше k
+  /// переносятся в возвращаемое дерево. Узлы не копируются, новое дерево
+  /// разделяет аллокатор с исходным. С Ranked — O(log n); без Ranked
+  /// размер частей неизвестен и находится обходом меньшей из них, итого
+  /// O(log n + min(m, n - m)), где m — размер возвращаемой части
+  AvlBst split(key_type const &k);
+
+  /// Соединение: все ключи left меньше k, все ключи right больше k, иначе
+  /// std::invalid_argument. left и right становятся пустыми.
+  /// O(|h(left) - h(right)| + 1)
+  static AvlBst join(AvlBst &left, key_type const &k, value_type const &v,
+                     AvlBst &right);
+
+  /// Удаление всех элементов с ключами из полуинтервала [lo, hi).
+  /// Возвращает их число. O(log n + m)
+  size_type erase(key_type const &lo, key_type const &hi);
+
+  /// Теоретико-множественные операции над ключами. other становится
+  /// пустым. При объединении данные совпадающих ключей берутся из other,
+  /// при пересечении — из этого дерева. Трудоёмкость – O (m log (n/m + 1)),
+  /// m ≤ n – размеры деревьев. Узлы другого аллокатора (отдельный пул
+  /// slab_allocator) предварительно копируются за O (m)
+  void set_union(AvlBst &other);
+  void set_intersection(AvlBst &other);
+  void set_difference(AvlBst &other);
+
+  /// То же, но поддеревья верхних уровней обрабатываются в отдельных
+  /// потоках (fork-join). Как и parallel_from_sorted, с аллокатором,
+  /// имеющим состояние, операции однопоточные
+  void parallel_set_union(
+      AvlBst &other, size_type threads = std::thread::hardware_concurrency());
+  void parallel_set_intersection(
+      AvlBst &other, size_type threads = std::thread::hardware_concurrency());
+  void parallel_set_difference(
+      AvlBst &other, size_type threads = std::thread::hardware_concurrency());
 
   size_type size() const;       // размер дерева
   void clear();                 // очистка дерева
   bool empty() const noexcept;  // проверка дерева на пустоту
 
-  reference at(key_type k);  // доступ по чтению/записи к данным по ключу
-  const reference at(key_type k) const;
-
-  void insert(key_type k, value_type v);  // включение данных с заданным ключом
-  void remove(key_type k);  // удаление данных с заданным ключом
+  // Поиск принимает ключ любого типа K. Прозрачному компаратору (как
+  // std::less<> по умолчанию) он передаётся как есть: например,
+  // std::string_view или строковый литерал при ключах std::string, без
+  // временного key_type. Для остальных компараторов из k строится key_type
+
+  // доступ по чтению/записи к данным по ключу
+  template <typename K = key_type>
+  reference at(K const &k);
+  template <typename K = key_type>
+  const reference at(K const &k) const;
+
+  // включение данных с заданным ключом
+  void insert(key_type const &k, value_type const &v);
+  void remove(key_type const &k);  // удаление данных с заданным ключом
+
+  // Включение, если ключа k ещё нет: данные строятся на месте из args.
+  // Иначе дерево не меняется, и args не используются. second – было ли
+  // включение
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type const &k, Args &&...args);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(key_type &&k, Args &&...args);
+  // включение или замена данных; second – было ли включение
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type const &k, M &&obj);
+  template <typename M>
+  std::pair<iterator, bool> insert_or_assign(key_type &&k, M &&obj);
+  // Узел строится из args до поиска: ключ – из первого аргумента, данные –
+  // из остальных. Если ключ уже есть, узел уничтожается
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args);
+
+  // поиск по ключу: итератор на элемент или end()
+  template <typename K = key_type>
+  iterator find(K const &k) noexcept;
+  // первый элемент с ключом не меньше k и первый с ключом больше k
+  template <typename K = key_type>
+  iterator lower_bound(K const &k) noexcept;
+  template <typename K = key_type>
+  iterator upper_bound(K const &k) noexcept;
+  // элементы с ключом k: пустой диапазон или один элемент
+  template <typename K = key_type>
+  std::pair<iterator, iterator> equal_range(K const &k) noexcept;
+  // элементы с ключами из полуинтервала [lo, hi). Трудоёмкость обхода –
+  // O (log n + m), где m – число элементов в диапазоне
+  template <typename K = key_type>
+  range_view range(K const &lo, K const &hi) noexcept;
 
   //формирование списка ключей в дереве в порядке обхода узлов по схеме,
   //заданной в варианте задания
@@ -44,6 +179,14 @@ class AvlBst {
   //определение высоты дерева. Трудоёмкость операции – O (n)
   size_type height() const noexcept;
 
+  // Порядковые запросы, только для RankedAvlBst. Трудоёмкость – O (log n)
+  iterator select(size_type k) noexcept;  // k-й по возрастанию ключ (с 0)
+  template <typename K = key_type>
+  size_type rank(K const &k) const noexcept;  // число ключей меньше k
+  // число ключей в полуинтервале [lo, hi)
+  template <typename K = key_type>
+  size_type count_range(K const &lo, K const &hi) const noexcept;
+
   //запрос прямого итератора, установленного на узел дерева с минимальным
   //ключом
   iterator begin() noexcept;
@@ -56,27 +199,118 @@ class AvlBst {
   //запрос «неустановленного» обратного итератора
   reverse_iterator rend() noexcept;
 
+  allocator_type get_allocator() const;
+  key_compare key_comp() const;
+
  private:
-  struct Node {
+  // Размер поддерева хранится только в ранговом дереве; в обычном база
+  // пуста и места в узле не занимает
+  template <bool R, typename = void>
+  struct NodeCount {};
+  template <typename Dummy>
+  struct NodeCount<true, Dummy> {
+    size_type count = 1;
+  };
+
+  struct Node : NodeCount<Ranked> {
     key_type key;
     value_type data;
-    size_type height = 0;
+    size_type height = 1;
     Node *left = nullptr;
     Node *right = nullptr;
+    // Родитель нужен итераторам: переход к соседнему узлу идёт вверх по
+    // дереву, а не поиском от корня
+    Node *parent = nullptr;
 
-    Node(key_type k, value_type v) : key(k), data(v) {}
-    ~Node() {
-      delete left;
-      delete right;
-    }
+    template <typename K, typename... Args>
+    explicit Node(K &&k, Args &&...args)
+        : key(std::forward<K>(k)), data(std::forward<Args>(args)...) {}
   };
 
-  void insert(key_type k, value_type v, Node *&node);
-  Node *remove(key_type k, Node *node);
-  Node *find(key_type k, Node *node);
-  Node *find_min(Node *node);
-  Node *find_max(Node *node);
-  size_type height(Node *node);
+  static constexpr key_search search_policy =
+      key_search_policy<key_type, key_compare>::value;
+
+  template <typename K>
+  static decltype(auto) lookup_key(K const &k);
+
+  // Все операции итеративны: спуск идёт циклом, а балансировка — подъёмом
+  // по родителям, так что стек не зависит от размера дерева
+  template <typename K>
+  Node *find_node(K const &k) const;
+  template <typename K>
+  Node *lower_node(K const &k) const;
+  template <typename K>
+  Node *upper_node(K const &k) const;
+  // Место ключа k: поле, в котором лежит узел с ключом k или в которое
+  // его нужно подвесить; parent – узел, которому принадлежит это поле
+  Node **find_link(key_type const &k, Node *&parent);
+  iterator attach_node(Node **link, Node *parent, Node *node);
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> try_emplace_key(K &&k, Args &&...args);
+  template <typename K, typename M>
+  std::pair<iterator, bool> insert_or_assign_key(K &&k, M &&obj);
+  Node *find_min(Node *node) const;
+  Node *find_max(Node *node) const;
+  size_type height(Node *node) const noexcept;
+  size_type count(Node *node) const noexcept;
+  void update(Node *node) noexcept;
+  void transplant(Node *u, Node *v);
+  size_type destroy(Node *node);
+  Node *clone(Node const *node);
+
+  using node_allocator = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  template <typename... Args>
+  Node *create_node(Args &&...args);
+  void free_node(Node *node) noexcept;
+  bool release_nodes() noexcept;
+
+  // Диапазоны короче порога parallel_from_sorted строит в одном потоке
+  static constexpr size_type parallel_build_threshold = 1 << 15;
+
+  template <typename ForwardIt>
+  void check_sorted(ForwardIt first, ForwardIt last) const;
+  template <typename ForwardIt>
+  Node *build_sorted(ForwardIt &it, size_type n);
+  template <typename ForwardIt>
+  Node *parallel_build_sorted(ForwardIt first, size_type n, size_type threads);
+  Node *link_nodes(Node *node, Node *left, Node *right) noexcept;
+
+  // Соединение и разделение поддеревьев. Поддеревья передаются корнями,
+  // указатель на родителя у корня результата не определён
+  Node *join_nodes(Node *left, Node *node, Node *right) noexcept;
+  Node *join_right(Node *left, Node *node, Node *right) noexcept;
+  Node *join_left(Node *left, Node *node, Node *right) noexcept;
+  Node *join2(Node *left, Node *right) noexcept;
+  Node *split_last(Node *tree, Node *&last) noexcept;
+  Node *split_nodes(Node *tree, key_type const &k, Node *&left,
+                    Node *&right) noexcept;
+
+  enum class SetOp { Union, Intersection, Difference };
+
+  // Поддеревья, у которых высота меньше порога, параллельные операции
+  // обрабатывают в одном потоке
+  static constexpr size_type parallel_set_height = 15;
+
+  Node *adopt(AvlBst &other);
+  void combine(SetOp op, AvlBst &other, size_type threads);
+  Node *combine_nodes(SetOp op, Node *t1, Node *t2, size_type threads,
+                      size_type &freed);
+
+  // Есть ли у аллокатора освобождение всего пула разом (slab_allocator)
+  template <typename A, typename = void>
+  struct has_release : std::false_type {};
+  template <typename A>
+  struct has_release<A, std::void_t<decltype(std::declval<A &>().release())>>
+      : std::true_type {};
+
+  node_allocator alloc_;
+  key_compare comp_;
+
+  Node *rebalance(Node *node);
+  void retrace(Node *node, bool grew);
 
   Node *left_rotate(Node *&t);
   Node *right_rotate(Node *&t);
@@ -96,6 +330,7 @@ class AvlBst {
     ~BstIterator(){};
 
     reference operator*() const noexcept { return current_->data; }
+    key_type const &key() const noexcept { return current_->key; }
 
     BstIterator &operator++() noexcept {
       current_ = find_next(current_);
@@ -109,12 +344,18 @@ class AvlBst {
     }
 
     BstIterator &operator--() noexcept {
-      current_ = find_prev(current_);
+      // Шаг назад от end() ведёт к наибольшему ключу
+      if (current_ == nullptr) {
+        current_ = bst_root_;
+        while (current_ && current_->right) current_ = current_->right;
+      } else {
+        current_ = find_prev(current_);
+      }
       return *this;
     }
     BstIterator operator--(int) noexcept {
       auto it = *this;
-      (*this);
+      --(*this);
       return it;
     }
 
@@ -126,49 +367,36 @@ class AvlBst {
     }
 
    private:
-    Node *find_parent(Node *node) { return find_parent(node, bst_root_); }
-    Node *find_parent(Node *node, Node *from) {
-      if (from == nullptr || node == nullptr) return nullptr;
-      if (from->left == node || from->right == node) return from;
-
-      if (node->key > from->key) {
-        return find_parent(node, from->right);
-      } else if (node->key < from->key) {
-        return find_parent(node, from->left);
-      }
-      return nullptr;
-    }
-
+    // Переход к соседнему узлу: спуск в поддерево или подъём по родителям.
+    // Полный обход проходит каждое ребро дважды, т.е. O(1) в среднем на шаг
     Node *find_next(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->right != nullptr) {
         node = node->right;
         while (node->left) node = node->left;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->left == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->right == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
 
     Node *find_prev(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->left != nullptr) {
         node = node->left;
         while (node->right) node = node->right;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->right == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->left == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
@@ -184,6 +412,7 @@ class AvlBst {
     ~ReverseBstIterator(){};
 
     reference operator*() const noexcept { return current_->data; }
+    key_type const &key() const noexcept { return current_->key; }
 
     ReverseBstIterator &operator++() noexcept {
       current_ = find_prev(current_);
@@ -196,12 +425,18 @@ class AvlBst {
     }
 
     ReverseBstIterator &operator--() noexcept {
-      current_ = find_next(current_);
+      // Шаг назад от rend() ведёт к наименьшему ключу
+      if (current_ == nullptr) {
+        current_ = bst_root_;
+        while (current_ && current_->left) current_ = current_->left;
+      } else {
+        current_ = find_next(current_);
+      }
       return *this;
     }
     ReverseBstIterator operator--(int) noexcept {
       auto it = *this;
-      (*this);
+      --(*this);
       return it;
     }
 
@@ -213,90 +448,187 @@ class AvlBst {
     }
 
    private:
-    Node *find_parent(Node *node) { return find_parent(node, bst_root_); }
-    Node *find_parent(Node *node, Node *from) {
-      if (from == nullptr || node == nullptr) return nullptr;
-      if (from->left == node || from->right == node) return from;
-
-      if (node->key > from->key) {
-        return find_parent(node, from->right);
-      } else if (node->key < from->key) {
-        return find_parent(node, from->left);
-      }
-      return nullptr;
-    }
-
+    // Переход к соседнему узлу: спуск в поддерево или подъём по родителям.
+    // Полный обход проходит каждое ребро дважды, т.е. O(1) в среднем на шаг
     Node *find_next(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->right != nullptr) {
         node = node->right;
         while (node->left) node = node->left;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->left == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->right == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
 
     Node *find_prev(Node *node) {
+      if (node == nullptr) return nullptr;
       if (node->left != nullptr) {
         node = node->left;
         while (node->right) node = node->right;
         return node;
       }
 
-      Node *parent = find_parent(node);
-
-      while (parent != nullptr) {
-        if (parent->right == node) break;
+      Node *parent = node->parent;
+      while (parent != nullptr && parent->left == node) {
         node = parent;
-        parent = find_parent(node);
+        parent = node->parent;
       }
       return parent;
     }
   };
+
+  // Диапазон [first, last) для цикла for по диапазону
+  class BstRange {
+   private:
+    iterator first_;
+    iterator last_;
+
+   public:
+    BstRange(iterator first, iterator last) : first_(first), last_(last){};
+
+    iterator begin() const noexcept { return first_; }
+    iterator end() const noexcept { return last_; }
+    bool empty() const noexcept { return first_ == last_; }
+  };
 };
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::insert(key_type k, value_type v) {
-  insert(k, v, root_);
-  size_++;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::insert(
+    key_type const &k, value_type const &v) {
+  insert_or_assign(k, v);
 }
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::insert(key_type k, value_type v, Node *&node) {
-  if (node == nullptr) {
-    node = new Node(k, v);
-  } else if (k < node->key) {
-    insert(k, v, node->left);
-    if (height(node->left) - height(node->right) == 2) {
-      if (k < node->left->key)
-        node = right_rotate(node);
-      else
-        node = double_right_rotate(node);
-    }
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename... Args>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::try_emplace(key_type const &k,
+                                                           Args &&...args) {
+  return try_emplace_key(k, std::forward<Args>(args)...);
+}
 
-  } else if (k > node->key) {
-    insert(k, v, node->right);
-    if (height(node->right) - height(node->left) == 2) {
-      if (k > node->right->data)
-        node = left_rotate(node);
-      else
-        node = double_left_rotate(node);
-    }
-  } else {  // if equal
-    node->data = v;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename... Args>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::try_emplace(key_type &&k,
+                                                           Args &&...args) {
+  return try_emplace_key(std::move(k), std::forward<Args>(args)...);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename M>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::insert_or_assign(
+    key_type const &k, M &&obj) {
+  return insert_or_assign_key(k, std::forward<M>(obj));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename M>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::insert_or_assign(
+    key_type &&k, M &&obj) {
+  return insert_or_assign_key(std::move(k), std::forward<M>(obj));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename... Args>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::emplace(Args &&...args) {
+  Node *node = create_node(std::forward<Args>(args)...);
+  Node *parent;
+  Node **link = find_link(node->key, parent);
+  if (*link != nullptr) {
+    free_node(node);
+    return {BstIterator(root_, *link), false};
   }
-  node->height = std::max(height(node->left), height(node->right)) + 1;
+  return {attach_node(link, parent, node), true};
 }
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::bf_print() const noexcept {
+// Ключ передаётся в узел, только если его ещё нет в дереве; поиск идёт по
+// ссылке на исходный ключ
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K, typename... Args>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::try_emplace_key(
+    K &&k, Args &&...args) {
+  Node *parent;
+  Node **link = find_link(k, parent);
+  if (*link != nullptr) return {BstIterator(root_, *link), false};
+  Node *node = create_node(std::forward<K>(k), std::forward<Args>(args)...);
+  return {attach_node(link, parent, node), true};
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K, typename M>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          bool>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::insert_or_assign_key(
+    K &&k, M &&obj) {
+  Node *parent;
+  Node **link = find_link(k, parent);
+  if (*link != nullptr) {
+    (*link)->data = std::forward<M>(obj);
+    return {BstIterator(root_, *link), false};
+  }
+  Node *node = create_node(std::forward<K>(k), std::forward<M>(obj));
+  return {attach_node(link, parent, node), true};
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node **
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::find_link(key_type const &k,
+                                                         Node *&parent) {
+  parent = nullptr;
+  Node **link = &root_;
+  while (*link != nullptr) {
+    int c = three_way(comp_, k, (*link)->key);
+    if (c == 0) break;
+    parent = *link;
+    link = c < 0 ? &parent->left : &parent->right;
+  }
+  return link;
+}
+
+// Подвешивание нового узла в поле link, найденное find_link, и
+// балансировка пути до корня. Итератор строится после поворотов: корень
+// мог смениться
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::attach_node(Node **link,
+                                                           Node *parent,
+                                                           Node *node) {
+  *link = node;
+  node->parent = parent;
+  size_++;
+  retrace(parent, true);
+  return BstIterator(root_, node);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::bf_print() const noexcept {
   if (root_ == nullptr) return;
 
   std::queue<Node *> q;
@@ -313,202 +645,1167 @@ void AvlBst<T_key, T_data>::bf_print() const noexcept {
   std::cout << std::endl;
 }
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::df_print() const noexcept {}
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::df_print() const noexcept {}
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::size_type AvlBst<T_key, T_data>::size() const {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size() const {
   return size_;
 }
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::clear() {
-  delete root_;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::clear() {
+  if (!release_nodes()) destroy(root_);
+  root_ = nullptr;
+  size_ = 0;
 }
 
-template <typename T_key, typename T_data>
-bool AvlBst<T_key, T_data>::empty() const noexcept {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+bool AvlBst<T_key, T_data, Alloc, Ranked, Compare>::empty() const noexcept {
   return size_ == 0;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::reference AvlBst<T_key, T_data>::at(
-    key_type k) {
-  return find(k, root_)->data;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::reference
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::at(K const &k) {
+  Node *node = find_node(lookup_key(k));
+  if (node == nullptr) throw std::out_of_range("AvlBst::at");
+  return node->data;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::reference AvlBst<T_key, T_data>::at(
-    key_type k) const {
-  return find(k, root_)->data;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::reference
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::at(K const &k) const {
+  Node *node = find_node(lookup_key(k));
+  if (node == nullptr) throw std::out_of_range("AvlBst::at");
+  return node->data;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::find(key_type k,
-                                                                  Node *node) {
-  if (node == nullptr) {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::find_node(K const &k) const {
+  if constexpr (search_policy == key_search::branchless) {
+    // Спуск до самого низа без ветвлений, совпадение проверяется один раз
+    Node *found = lower_node(k);
+    if (found != nullptr && comp_(k, found->key)) return nullptr;
+    return found;
+  } else {
+    Node *node = root_;
+    while (node != nullptr) {
+      int c = three_way(comp_, k, node->key);
+      if (c < 0) {
+        node = node->left;
+      } else if (c > 0) {
+        node = node->right;
+      } else {  // equal
+        return node;
+      }
+    }
     return nullptr;
-  } else if (k > node->key) {
-    return find(k, node->right);
-  } else if (k < node->key) {
-    return find(k, node->left);
-  } else {  // equal
-    return node;
   }
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::size_type AvlBst<T_key, T_data>::height()
-    const noexcept {
-  return height(root_);
+// Первый узел с ключом не меньше k
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::lower_node(K const &k) const {
+  Node *node = root_;
+  Node *found = nullptr;
+  while (node != nullptr) {
+    bool less = comp_(node->key, k);
+    if constexpr (search_policy == key_search::branchless) {
+      // Сын выбирается индексом, а не переходом: исход сравнения
+      // становится данными, и предсказывать его процессору не нужно
+      Node *const next[2] = {node->left, node->right};
+      found = less ? found : node;
+      node = next[less];
+    } else if (less) {
+      node = node->right;
+    } else {
+      found = node;
+      node = node->left;
+    }
+  }
+  return found;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::size_type AvlBst<T_key, T_data>::height(
-    Node *node) {
-  return (node == nullptr ? -1 : node->height);
+// Первый узел с ключом больше k
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::upper_node(K const &k) const {
+  Node *node = root_;
+  Node *found = nullptr;
+  while (node != nullptr) {
+    bool greater = comp_(k, node->key);
+    if constexpr (search_policy == key_search::branchless) {
+      Node *const next[2] = {node->right, node->left};
+      found = greater ? node : found;
+      node = next[greater];
+    } else if (greater) {
+      found = node;
+      node = node->left;
+    } else {
+      node = node->right;
+    }
+  }
+  return found;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::find_min(
-    Node *node) {
-  if (node == nullptr) {
-    return nullptr;
-  } else if (node->left == nullptr) {
-    return node;
+// Ключ другого типа передаётся непрозрачному компаратору после
+// преобразования в key_type
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+decltype(auto) AvlBst<T_key, T_data, Alloc, Ranked, Compare>::lookup_key(
+    K const &k) {
+  if constexpr (std::is_same_v<K, key_type> ||
+                is_transparent<key_compare>::value) {
+    return (k);
   } else {
-    return find_min(node->left);
+    return key_type(k);
   }
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::find_max(
-    Node *node) {
-  if (node == nullptr) {
-    return nullptr;
-  } else if (node->right == nullptr) {
-    return node;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::find(K const &k) noexcept {
+  return BstIterator(root_, find_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::lower_bound(
+    K const &k) noexcept {
+  return BstIterator(root_, lower_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::upper_bound(
+    K const &k) noexcept {
+  return BstIterator(root_, upper_node(lookup_key(k)));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+std::pair<typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator,
+          typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::equal_range(
+    K const &k) noexcept {
+  // Ключи уникальны, поэтому хватает одного спуска
+  auto const &key = lookup_key(k);
+  Node *lower = lower_node(key);
+  iterator first(root_, lower);
+  iterator last = first;
+  if (lower != nullptr && !comp_(key, lower->key)) ++last;
+  return {first, last};
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::range_view
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::range(
+    K const &lo, K const &hi) noexcept {
+  iterator first = lower_bound(lo);
+  if (!comp_(lookup_key(lo), lookup_key(hi))) return BstRange(first, first);
+  return BstRange(first, lower_bound(hi));
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::height() const noexcept {
+  return height(root_);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::height(
+    Node *node) const noexcept {
+  return (node == nullptr ? 0 : node->height);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::count(
+    Node *node) const noexcept {
+  if constexpr (Ranked) {
+    return (node == nullptr ? 0 : node->count);
   } else {
-    return find_max(node->right);
+    return 0;
   }
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::iterator
-AvlBst<T_key, T_data>::begin() noexcept {
+// Пересчёт высоты и размера поддерева по сыновьям
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::update(
+    Node *node) noexcept {
+  node->height = 1 + std::max(height(node->left), height(node->right));
+  if constexpr (Ranked) {
+    node->count = 1 + count(node->left) + count(node->right);
+  }
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::select(size_type k) noexcept {
+  static_assert(Ranked, "select() is available in RankedAvlBst only");
+  Node *node = root_;
+  while (node != nullptr) {
+    size_type left = count(node->left);
+    if (k < left) {
+      node = node->left;
+    } else if (k > left) {
+      k -= left + 1;
+      node = node->right;
+    } else {
+      break;
+    }
+  }
+  return BstIterator(root_, node);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::rank(K const &k) const noexcept {
+  static_assert(Ranked, "rank() is available in RankedAvlBst only");
+  size_type less = 0;
+  Node *node = root_;
+  while (node != nullptr) {
+    if (comp_(node->key, k)) {
+      less += count(node->left) + 1;
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return less;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename K>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::count_range(
+    K const &lo, K const &hi) const noexcept {
+  auto const &lo_key = lookup_key(lo);
+  auto const &hi_key = lookup_key(hi);
+  if (!comp_(lo_key, hi_key)) return 0;
+  return rank(hi_key) - rank(lo_key);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::find_min(Node *node) const {
+  if (node == nullptr) return nullptr;
+  while (node->left != nullptr) node = node->left;
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::find_max(Node *node) const {
+  if (node == nullptr) return nullptr;
+  while (node->right != nullptr) node = node->right;
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::begin() noexcept {
   return BstIterator(root_, find_min(root_));
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::iterator AvlBst<T_key, T_data>::end() noexcept {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::end() noexcept {
   return BstIterator(root_, nullptr);
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::reverse_iterator
-AvlBst<T_key, T_data>::rbegin() noexcept {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::reverse_iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::rbegin() noexcept {
   return ReverseBstIterator(root_, find_max(root_));
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::reverse_iterator
-AvlBst<T_key, T_data>::rend() noexcept {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::reverse_iterator
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::rend() noexcept {
   return ReverseBstIterator(root_, nullptr);
 }
 
-template <typename T_key, typename T_data>
-void AvlBst<T_key, T_data>::remove(key_type k) {
-  remove(k, root_);
-}
-
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::remove(
-    key_type k, Node *node) {
-  if (node == nullptr) return nullptr;
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::remove(key_type const &k) {
+  Node *node = find_node(k);
+  if (node == nullptr) return;
 
-  if (k < node->key) {
-    node->left = remove(k, node->left);
-  } else if (k > node->key) {
-    node->right = remove(k, node->right);
+  // Самый нижний узел, у которого изменилось поддерево
+  Node *changed = node->parent;
+  if (node->left == nullptr) {
+    transplant(node, node->right);
+  } else if (node->right == nullptr) {
+    transplant(node, node->left);
   } else {
-    if (node->left == nullptr) {
-      Node *right_node = node->right;
-      node->right = node->left = nullptr;
-      delete node;
-      return right_node;
+    // Узел заменяется своим преемником; узлы не копируются, поэтому
+    // итераторы на остальные элементы остаются действительными
+    Node *next = find_min(node->right);
+    changed = next;
+    if (next->parent != node) {
+      changed = next->parent;
+      transplant(next, next->right);
+      next->right = node->right;
+      next->right->parent = next;
     }
+    transplant(node, next);
+    next->left = node->left;
+    next->left->parent = next;
+    next->height = node->height;
+    if constexpr (Ranked) next->count = node->count;
+  }
 
-    if (node->right == nullptr) {
-      Node *left_child = node->left;
-      node->right = node->left = nullptr;
-      delete node;
-      return left_child;
-    }
+  free_node(node);
+  size_--;
+  retrace(changed, false);
+}
 
-    Node *min_node = find_min(node->right);
-    node->key = min_node->key;
-    node->data = min_node->data;
-    node->right = remove(min_node->key, node->right);
+// Замена поддерева u поддеревом v в родителе u
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::transplant(
+    Node *u, Node *v) {
+  if (u->parent == nullptr) {
+    root_ = v;
+  } else if (u == u->parent->left) {
+    u->parent->left = v;
+  } else {
+    u->parent->right = v;
   }
+  if (v != nullptr) v->parent = u->parent;
+}
 
-  if (node == nullptr) return node;
-
-  node->height = 1 + std::max(height(node->left), height(node->right));
-  int bal = (int)(height(node->left) - height(node->right));
-  if (bal > 1) {
-    if (height(node->left) >= height(node->right)) {
-      return right_rotate(node);
+// Разрушение поддерева без рекурсии: левый сын поворотом поднимается на
+// место узла, пока левых сыновей не останется; узел без левого сына
+// удаляется, и обход продолжается с правого
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::destroy(Node *node) {
+  size_type freed = 0;
+  while (node != nullptr) {
+    if (node->left != nullptr) {
+      Node *left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
     } else {
-      node->left = left_rotate(node->left);
-      return right_rotate(node);
+      Node *right = node->right;
+      free_node(node);
+      freed++;
+      node = right;
     }
-  } else if (bal < -1) {
-    if (height(node->right) >= height(node->left)) {
+  }
+  return freed;
+}
+
+// Пересчёт высоты узла и, при нарушении баланса, поворот. Возвращает новую
+// вершину поддерева
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::rebalance(Node *node) {
+  update(node);
+  if (height(node->left) > height(node->right) + 1) {
+    if (height(node->left->left) >= height(node->left->right))
+      return right_rotate(node);
+    return double_right_rotate(node);
+  }
+  if (height(node->right) > height(node->left) + 1) {
+    if (height(node->right->right) >= height(node->right->left))
       return left_rotate(node);
+    return double_left_rotate(node);
+  }
+  return node;
+}
+
+// Подъём от node к корню с балансировкой после вставки (grew) или удаления
+// узла. Высоты выше node ещё прежние, поэтому балансировка прекращается,
+// как только высота поддерева не изменилась: после вставки это происходит
+// не позже первого поворота
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::retrace(
+    Node *node, bool grew) {
+  while (node != nullptr) {
+    Node *parent = node->parent;
+    size_type old_height = node->height;
+    Node *top = rebalance(node);
+
+    if (parent == nullptr) {
+      root_ = top;
+    } else if (parent->left == node) {
+      parent->left = top;
     } else {
-      node->right = right_rotate(node->right);
-      return left_rotate(node);
+      parent->right = top;
     }
+
+    if (top->height == old_height) {
+      // Выше меняются только размеры поддеревьев, ровно на единицу:
+      // сыновей перечитывать не нужно
+      if constexpr (Ranked) {
+        for (; parent != nullptr; parent = parent->parent) {
+          if (grew) {
+            parent->count++;
+          } else {
+            parent->count--;
+          }
+        }
+      }
+      return;
+    }
+    node = parent;
   }
-  return node;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::left_rotate(
-    Node *&t) {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::left_rotate(Node *&t) {
   if (t->right == nullptr) return t;
   Node *u = t->right;
   t->right = u->left;
+  if (t->right != nullptr) t->right->parent = t;
   u->left = t;
-  t->height = std::max(height(t->left), height(t->right)) + 1;
-  u->height = std::max(height(t->right), t->height) + 1;
+  u->parent = t->parent;
+  t->parent = u;
+  update(t);
+  update(u);
   return u;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::right_rotate(
-    Node *&t) {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::right_rotate(Node *&t) {
   if (t->left == nullptr) return t;
   Node *u = t->left;
   t->left = u->right;
+  if (t->left != nullptr) t->left->parent = t;
   u->right = t;
-  t->height = std::max(height(t->left), height(t->right)) + 1;
-  u->height = std::max(height(u->left), t->height) + 1;
+  u->parent = t->parent;
+  t->parent = u;
+  update(t);
+  update(u);
   return u;
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *AvlBst<T_key, T_data>::double_left_rotate(
-    Node *&t) {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::double_left_rotate(Node *&t) {
   t->right = right_rotate(t->right);
   return left_rotate(t);
 }
 
-template <typename T_key, typename T_data>
-typename AvlBst<T_key, T_data>::Node *
-AvlBst<T_key, T_data>::double_right_rotate(Node *&t) {
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::double_right_rotate(Node *&t) {
   t->left = left_rotate(t->left);
   return right_rotate(t);
 }
 
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::allocator_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::get_allocator() const {
+  return allocator_type(alloc_);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::key_compare
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::key_comp() const {
+  return comp_;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename... Args>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::create_node(Args &&...args) {
+  Node *node = node_traits::allocate(alloc_, 1);
+  try {
+    node_traits::construct(alloc_, node, std::forward<Args>(args)...);
+  } catch (...) {
+    node_traits::deallocate(alloc_, node, 1);
+    throw;
+  }
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::free_node(
+    Node *node) noexcept {
+  node_traits::destroy(alloc_, node);
+  node_traits::deallocate(alloc_, node, 1);
+}
+
+// Если пул можно освободить целиком, а узлы не требуют вызова деструктора,
+// дерево не обходится
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+bool AvlBst<T_key, T_data, Alloc, Ranked, Compare>::release_nodes() noexcept {
+  if constexpr (std::is_trivially_destructible_v<Node> &&
+                has_release<node_allocator>::value) {
+    return alloc_.release();
+  }
+  return false;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::AvlBst(AvlBst const &b)
+    : alloc_(node_traits::select_on_container_copy_construction(b.alloc_)),
+      comp_(b.comp_) {
+  root_ = clone(b.root_);
+  size_ = b.size_;
+}
+
+// Копия поддерева той же формы за O(n). Обход идёт по ссылкам на родителей
+// в обоих деревьях сразу, поэтому стек не нужен. При исключении уже
+// скопированные узлы освобождаются
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::clone(Node const *node) {
+  if (node == nullptr) return nullptr;
+
+  auto copy = [this](Node const *from, Node *parent) {
+    Node *to = create_node(from->key, from->data);
+    to->height = from->height;
+    if constexpr (Ranked) to->count = from->count;
+    to->parent = parent;
+    return to;
+  };
+
+  Node *top = copy(node, nullptr);
+  try {
+    Node const *from = node;
+    Node *to = top;
+    while (true) {
+      if (from->left != nullptr && to->left == nullptr) {
+        to->left = copy(from->left, to);
+        from = from->left;
+        to = to->left;
+      } else if (from->right != nullptr && to->right == nullptr) {
+        to->right = copy(from->right, to);
+        from = from->right;
+        to = to->right;
+      } else if (from == node) {
+        break;
+      } else {
+        from = from->parent;
+        to = to->parent;
+      }
+    }
+  } catch (...) {
+    destroy(top);
+    throw;
+  }
+  return top;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::AvlBst(AvlBst &&b) : AvlBst() {
+  swap(b);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare> &
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::operator=(AvlBst const &b) {
+  if (this != &b) {
+    AvlBst(b).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare> &
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::operator=(AvlBst &&b) {
+  if (this != &b) {
+    AvlBst(std::move(b)).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::swap(AvlBst &other) {
+  std::swap(root_, other.root_);
+  std::swap(size_, other.size_);
+  std::swap(comp_, other.comp_);
+  if constexpr (node_traits::propagate_on_container_swap::value) {
+    std::swap(alloc_, other.alloc_);
+  }
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename ForwardIt>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::from_sorted(ForwardIt first,
+                                                           ForwardIt last) {
+  AvlBst tree;
+  tree.check_sorted(first, last);
+  auto n = static_cast<size_type>(std::distance(first, last));
+  tree.root_ = tree.build_sorted(first, n);
+  tree.size_ = n;
+  return tree;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename ForwardIt>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::parallel_from_sorted(
+    ForwardIt first, ForwardIt last, size_type threads) {
+  AvlBst tree;
+  tree.check_sorted(first, last);
+  auto n = static_cast<size_type>(std::distance(first, last));
+  if (!node_traits::is_always_equal::value) threads = 1;
+  tree.root_ = tree.parallel_build_sorted(first, n, threads);
+  tree.size_ = n;
+  return tree;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename ForwardIt>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::check_sorted(
+    ForwardIt first, ForwardIt last) const {
+  if (first == last) return;
+  for (ForwardIt next = std::next(first); next != last; first = next++) {
+    if (!comp_(first->first, next->first)) {
+      throw std::invalid_argument(
+          "AvlBst::from_sorted: keys are not increasing");
+    }
+  }
+}
+
+// Построение поддерева из n очередных элементов: сначала левая половина,
+// затем корень, затем правая, так что диапазон читается один раз по
+// порядку. Глубина рекурсии — высота дерева, т.е. O(log n). При исключении
+// уже созданные узлы поддерева освобождаются
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename ForwardIt>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::build_sorted(
+    ForwardIt &it, size_type n) {
+  if (n == 0) return nullptr;
+
+  size_type left_size = (n - 1) / 2;
+  Node *left = build_sorted(it, left_size);
+  Node *node;
+  try {
+    node = create_node(it->first, it->second);
+    ++it;
+  } catch (...) {
+    destroy(left);
+    throw;
+  }
+
+  Node *right;
+  try {
+    right = build_sorted(it, n - 1 - left_size);
+  } catch (...) {
+    destroy(left);
+    free_node(node);
+    throw;
+  }
+  return link_nodes(node, left, right);
+}
+
+// Левое поддерево строит новый поток, корень и правое — текущий; потоки
+// делятся поровну между половинами
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+template <typename ForwardIt>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::parallel_build_sorted(
+    ForwardIt first, size_type n, size_type threads) {
+  if (threads < 2 || n < parallel_build_threshold) {
+    return build_sorted(first, n);
+  }
+
+  size_type left_size = (n - 1) / 2;
+  ForwardIt middle = std::next(first, static_cast<std::ptrdiff_t>(left_size));
+
+  Node *left = nullptr;
+  std::exception_ptr left_error;
+  std::thread worker([&] {
+    try {
+      left = parallel_build_sorted(first, left_size, threads / 2);
+    } catch (...) {
+      left_error = std::current_exception();
+    }
+  });
+
+  Node *node = nullptr;
+  Node *right = nullptr;
+  try {
+    node = create_node(middle->first, middle->second);
+    right = parallel_build_sorted(std::next(middle), n - 1 - left_size,
+                                  threads - threads / 2);
+  } catch (...) {
+    worker.join();
+    destroy(left);
+    if (node != nullptr) free_node(node);
+    throw;
+  }
+
+  worker.join();
+  if (left_error) {
+    destroy(right);
+    free_node(node);
+    std::rethrow_exception(left_error);
+  }
+
+  return link_nodes(node, left, right);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::link_nodes(
+    Node *node, Node *left, Node *right) noexcept {
+  node->left = left;
+  if (left != nullptr) left->parent = node;
+  node->right = right;
+  if (right != nullptr) right->parent = node;
+  update(node);
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::split(key_type const &k) {
+  Node *left;
+  Node *right;
+  Node *node = split_nodes(root_, k, left, right);
+  if (node != nullptr) right = join_nodes(nullptr, node, right);
+
+  AvlBst part;
+  part.alloc_ = alloc_;
+  part.comp_ = comp_;
+  part.root_ = right;
+  root_ = left;
+  if (root_ != nullptr) root_->parent = nullptr;
+  if (right != nullptr) right->parent = nullptr;
+
+  if constexpr (Ranked) {
+    part.size_ = count(right);
+  } else {
+    // Обе части обходятся по очереди, пока не кончится меньшая
+    auto mine = begin();
+    auto theirs = part.begin();
+    size_type steps = 0;
+    while (mine != end() && theirs != part.end()) {
+      ++mine;
+      ++theirs;
+      ++steps;
+    }
+    part.size_ = theirs == part.end() ? steps : size_ - steps;
+  }
+  size_ -= part.size_;
+  return part;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::join(
+    AvlBst &left, key_type const &k, value_type const &v, AvlBst &right) {
+  key_compare const &comp = left.comp_;
+  if ((left.root_ != nullptr && !comp(left.find_max(left.root_)->key, k)) ||
+      (right.root_ != nullptr && !comp(k, right.find_min(right.root_)->key))) {
+    throw std::invalid_argument("AvlBst::join: keys are not ordered");
+  }
+
+  Node *node = left.create_node(k, v);
+  size_type right_size = right.size_;
+  Node *right_root;
+  try {
+    right_root = left.adopt(right);
+  } catch (...) {
+    left.free_node(node);
+    throw;
+  }
+
+  AvlBst tree(std::move(left));
+  tree.root_ = tree.join_nodes(tree.root_, node, right_root);
+  tree.root_->parent = nullptr;
+  tree.size_ += right_size + 1;
+  return tree;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::size_type
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::erase(key_type const &lo,
+                                                     key_type const &hi) {
+  if (!comp_(lo, hi)) return 0;
+
+  // root_ = left + [lo] + middle + [hi] + right
+  Node *left;
+  Node *rest;
+  Node *middle;
+  Node *right;
+  Node *first = split_nodes(root_, lo, left, rest);
+  Node *last = split_nodes(rest, hi, middle, right);
+  if (last != nullptr) right = join_nodes(nullptr, last, right);
+
+  size_type erased = destroy(middle);
+  if (first != nullptr) {
+    free_node(first);
+    erased++;
+  }
+
+  root_ = join2(left, right);
+  if (root_ != nullptr) root_->parent = nullptr;
+  size_ -= erased;
+  return erased;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::set_union(AvlBst &other) {
+  combine(SetOp::Union, other, 1);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::set_intersection(
+    AvlBst &other) {
+  combine(SetOp::Intersection, other, 1);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::set_difference(
+    AvlBst &other) {
+  combine(SetOp::Difference, other, 1);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::parallel_set_union(
+    AvlBst &other, size_type threads) {
+  combine(SetOp::Union, other, threads);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::parallel_set_intersection(
+    AvlBst &other, size_type threads) {
+  combine(SetOp::Intersection, other, threads);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::parallel_set_difference(
+    AvlBst &other, size_type threads) {
+  combine(SetOp::Difference, other, threads);
+}
+
+// Соединение по высотам: если одно поддерево заметно выше, node
+// спускается по его краю до поддерева подходящей высоты, после чего
+// баланс восстанавливается не более чем двумя поворотами на каждом уровне
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::join_nodes(
+    Node *left, Node *node, Node *right) noexcept {
+  if (height(left) > height(right) + 1) return join_right(left, node, right);
+  if (height(right) > height(left) + 1) return join_left(left, node, right);
+  return link_nodes(node, left, right);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::join_right(
+    Node *left, Node *node, Node *right) noexcept {
+  Node *inner = left->right;
+  if (height(inner) <= height(right) + 1) {
+    Node *sub = link_nodes(node, inner, right);
+    if (height(sub) <= height(left->left) + 1) {
+      return link_nodes(left, left->left, sub);
+    }
+    sub = right_rotate(sub);
+    link_nodes(left, left->left, sub);
+    return left_rotate(left);
+  }
+
+  Node *sub = join_right(inner, node, right);
+  link_nodes(left, left->left, sub);
+  if (height(sub) <= height(left->left) + 1) return left;
+  return left_rotate(left);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::join_left(
+    Node *left, Node *node, Node *right) noexcept {
+  Node *inner = right->left;
+  if (height(inner) <= height(left) + 1) {
+    Node *sub = link_nodes(node, left, inner);
+    if (height(sub) <= height(right->right) + 1) {
+      return link_nodes(right, sub, right->right);
+    }
+    sub = left_rotate(sub);
+    link_nodes(right, sub, right->right);
+    return right_rotate(right);
+  }
+
+  Node *sub = join_left(left, node, inner);
+  link_nodes(right, sub, right->right);
+  if (height(sub) <= height(right->right) + 1) return right;
+  return right_rotate(right);
+}
+
+// Соединение без разделяющего узла: им становится наибольший узел left
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::join2(
+    Node *left, Node *right) noexcept {
+  if (left == nullptr) return right;
+  if (right == nullptr) return left;
+
+  Node *last;
+  Node *rest = split_last(left, last);
+  return join_nodes(rest, last, right);
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::split_last(
+    Node *tree, Node *&last) noexcept {
+  if (tree->right == nullptr) {
+    last = tree;
+    Node *rest = tree->left;
+    link_nodes(tree, nullptr, nullptr);
+    return rest;
+  }
+
+  Node *rest = split_last(tree->right, last);
+  return join_nodes(tree->left, tree, rest);
+}
+
+// Разделение поддерева по ключу k на ключи меньше и больше k. Узел с
+// ключом k, если он есть, возвращается отдельно
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::split_nodes(
+    Node *tree, key_type const &k, Node *&left, Node *&right) noexcept {
+  if (tree == nullptr) {
+    left = right = nullptr;
+    return nullptr;
+  }
+
+  Node *tree_left = tree->left;
+  Node *tree_right = tree->right;
+  int c = three_way(comp_, k, tree->key);
+  if (c < 0) {
+    Node *found = split_nodes(tree_left, k, left, right);
+    right = join_nodes(right, tree, tree_right);
+    return found;
+  }
+  if (c > 0) {
+    Node *found = split_nodes(tree_right, k, left, right);
+    left = join_nodes(tree_left, tree, left);
+    return found;
+  }
+
+  left = tree_left;
+  right = tree_right;
+  link_nodes(tree, nullptr, nullptr);
+  tree->parent = nullptr;
+  return tree;
+}
+
+// Передача узлов other этому дереву. Узлы аллокатора, который не может
+// освободить память этого дерева, копируются
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::adopt(AvlBst &other) {
+  Node *root = other.root_;
+  if (!node_traits::is_always_equal::value && !(alloc_ == other.alloc_)) {
+    std::vector<std::pair<key_type, value_type>> items;
+    items.reserve(other.size_);
+    for (auto it = other.begin(); it != other.end(); ++it) {
+      items.emplace_back(it.key(), *it);
+    }
+    auto first = items.begin();
+    root = build_sorted(first, items.size());
+    other.clear();
+  }
+
+  other.root_ = nullptr;
+  other.size_ = 0;
+  return root;
+}
+
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+void AvlBst<T_key, T_data, Alloc, Ranked, Compare>::combine(SetOp op,
+                                                            AvlBst &other,
+                                                            size_type threads) {
+  if (this == &other) {
+    if (op == SetOp::Difference) clear();
+    return;
+  }
+  if (!node_traits::is_always_equal::value) threads = 1;
+
+  size_type total = size_ + other.size_;
+  Node *other_root = adopt(other);
+  size_type freed = 0;
+  root_ = combine_nodes(op, root_, other_root, threads, freed);
+  if (root_ != nullptr) root_->parent = nullptr;
+  size_ = total - freed;
+}
+
+// Корень t1 делит t2 по своему ключу, половины обрабатываются рекурсивно
+// (при threads > 1 левая — в новом потоке) и соединяются обратно через
+// корень или, если он выбывает, через join2. Каждый узел обоих деревьев
+// либо остаётся в результате, либо освобождается и учитывается в freed
+template <typename T_key, typename T_data, typename Alloc, bool Ranked,
+          typename Compare>
+typename AvlBst<T_key, T_data, Alloc, Ranked, Compare>::Node *
+AvlBst<T_key, T_data, Alloc, Ranked, Compare>::combine_nodes(
+    SetOp op, Node *t1, Node *t2, size_type threads, size_type &freed) {
+  if (t1 == nullptr) {
+    if (op == SetOp::Union) return t2;
+    freed += destroy(t2);
+    return nullptr;
+  }
+  if (t2 == nullptr) {
+    if (op != SetOp::Intersection) return t1;
+    freed += destroy(t1);
+    return nullptr;
+  }
+
+  Node *left1 = t1->left;
+  Node *right1 = t1->right;
+  link_nodes(t1, nullptr, nullptr);
+  Node *left2;
+  Node *right2;
+  Node *match = split_nodes(t2, t1->key, left2, right2);
+
+  Node *left = nullptr;
+  Node *right;
+  bool forked = false;
+  if (threads > 1 && height(left1) + 1 >= parallel_set_height) {
+    size_type left_freed = 0;
+    std::thread worker;
+    try {
+      worker = std::thread([&, left1, left2] {
+        left = combine_nodes(op, left1, left2, threads / 2, left_freed);
+      });
+      forked = true;
+    } catch (std::system_error const &) {
+      // Без нового потока левая половина обрабатывается в этом
+    }
+    if (forked) {
+      right = combine_nodes(op, right1, right2, threads - threads / 2, freed);
+      worker.join();
+      freed += left_freed;
+    }
+  }
+  if (!forked) {
+    left = combine_nodes(op, left1, left2, 1, freed);
+    right = combine_nodes(op, right1, right2, 1, freed);
+  }
+
+  // Корень t1 остаётся, если его ключ входит в результат; при объединении
+  // вместо него остаётся пара из other
+  Node *keep = t1;
+  if (match != nullptr) {
+    if (op == SetOp::Union) {
+      free_node(t1);
+      keep = match;
+    } else {
+      free_node(match);
+      if (op == SetOp::Difference) {
+        free_node(t1);
+        freed++;
+        keep = nullptr;
+      }
+    }
+    freed++;
+  } else if (op == SetOp::Intersection) {
+    free_node(t1);
+    freed++;
+    keep = nullptr;
+  }
+
+  if (keep == nullptr) return join2(left, right);
+  return join_nodes(left, keep, right);
+}
+
+template <typename T_key, typename T_data>
+using PooledAvlBst =
+    AvlBst<T_key, T_data, slab_allocator<std::pair<const T_key, T_data>>>;
+
+template <typename T_key, typename T_data,
+          typename Alloc = std::allocator<std::pair<const T_key, T_data>>,
+          typename Compare = std::less<>>
+using RankedAvlBst = AvlBst<T_key, T_data, Alloc, true, Compare>;
+
 #endif  // BSTREE_H_
\ No newline at end of file
@@ -0,0 +1,651 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "avl_bstree.h"
+#include "concurrent_avl_bstree.h"
+#include "persistent_avl_bstree.h"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// Результаты вычислений сохраняются сюда, чтобы компилятор их не выбросил
+volatile long long sink;
+
+template <typename F>
+double measure_ms(F &&f) {
+  auto start = clock_type::now();
+  f();
+  std::chrono::duration<double, std::milli> d = clock_type::now() - start;
+  return d.count();
+}
+
+std::vector<int> shuffled_keys(std::size_t n, unsigned seed) {
+  std::vector<int> keys(n);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+  return keys;
+}
+
+// Полный обход дерева итераторами в обе стороны
+void bench_iteration() {
+  std::printf("%-32s %13s %13s\n", "AvlBst<int, int>, random keys", "forward",
+              "reverse");
+
+  for (std::size_t n : {10000u, 100000u, 1000000u}) {
+    AvlBst<int, int> tree;
+    for (int k : shuffled_keys(n, 1)) tree.insert(k, k);
+
+    long long sum = 0;
+    double forward_ms = measure_ms([&] {
+      for (auto it = tree.begin(); it != tree.end(); ++it) sum += *it;
+    });
+    double reverse_ms = measure_ms([&] {
+      for (auto it = tree.rbegin(); it != tree.rend(); ++it) sum += *it;
+    });
+    sink = sum;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%zu elements", n);
+    std::printf("%-32s %10.2f ms %10.2f ms\n", name, forward_ms, reverse_ms);
+  }
+}
+
+// Вставка, поиск, удаление половины ключей и разрушение дерева при
+// заданном порядке ключей
+void bench_order_row(char const *name, std::vector<int> const &keys) {
+  auto tree = std::make_unique<AvlBst<int, int>>();
+  long long sum = 0;
+
+  double insert_ms = measure_ms([&] {
+    for (int k : keys) tree->insert(k, k);
+  });
+  double find_ms = measure_ms([&] {
+    for (int k : keys) sum += tree->at(k);
+  });
+  double remove_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < keys.size(); i += 2) tree->remove(keys[i]);
+  });
+  double teardown_ms = measure_ms([&] { tree.reset(); });
+  sink = sum;
+
+  std::printf("%-24s %9.2f ms %9.2f ms %9.2f ms %9.2f ms\n", name, insert_ms,
+              find_ms, remove_ms, teardown_ms);
+}
+
+void bench_orders() {
+  std::printf("\n%-24s %12s %12s %12s %12s\n", "AvlBst<int, int>", "insert",
+              "find", "remove 1/2", "teardown");
+
+  std::vector<int> sorted(1000000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  bench_order_row("10^6 sorted keys", sorted);
+  bench_order_row("10^6 random keys", shuffled_keys(1000000, 2));
+}
+
+// Цикл перестроения индекса: построение, обновление половины ключей
+// (удаление и повторная вставка) и очистка
+template <typename Tree>
+void bench_rebuild_row(char const *name, std::vector<int> const &keys) {
+  Tree tree;
+  double build_ms = measure_ms([&] {
+    for (int k : keys) tree.insert(k, k);
+  });
+  double churn_ms = measure_ms([&] {
+    for (std::size_t i = 0; i < keys.size(); i += 2) tree.remove(keys[i]);
+    for (std::size_t i = 0; i < keys.size(); i += 2) {
+      tree.insert(keys[i], keys[i]);
+    }
+  });
+  double clear_ms = measure_ms([&] { tree.clear(); });
+  sink = static_cast<long long>(tree.size());
+
+  std::printf("%-24s %9.2f ms %9.2f ms %9.2f ms\n", name, build_ms, churn_ms,
+              clear_ms);
+}
+
+void bench_rebuild() {
+  std::printf("\n%-24s %12s %12s %12s\n", "10^6 random keys", "build",
+              "churn 1/2", "clear");
+
+  auto keys = shuffled_keys(1000000, 4);
+  bench_rebuild_row<AvlBst<int, int>>("std::allocator", keys);
+  bench_rebuild_row<PooledAvlBst<int, int>>("slab_allocator", keys);
+}
+
+// Время построения дерева; разрушение в замер не входит
+template <typename Build>
+void bench_build_row(char const *name, Build build) {
+  using tree_type = decltype(build());
+  std::unique_ptr<tree_type> tree;
+  double build_ms =
+      measure_ms([&] { tree = std::make_unique<tree_type>(build()); });
+  sink = static_cast<long long>(tree->size());
+
+  std::printf("%-24s %9.2f ms\n", name, build_ms);
+}
+
+// Загрузка отсортированного массива пар
+void bench_bulk_load() {
+  std::size_t const n = 10000000;
+  std::printf("\n%-24s %12s\n", "10^7 sorted pairs", "build");
+
+  std::vector<std::pair<int, int>> items(n);
+  for (std::size_t i = 0; i < n; i++) {
+    items[i] = {static_cast<int>(i), static_cast<int>(i)};
+  }
+
+  // Первое построение платит за получение страниц у системы, поэтому
+  // оно не замеряется
+  AvlBst<int, int>::from_sorted(items.begin(), items.end());
+
+  bench_build_row("from_sorted", [&] {
+    return AvlBst<int, int>::from_sorted(items.begin(), items.end());
+  });
+  bench_build_row("parallel_from_sorted", [&] {
+    return AvlBst<int, int>::parallel_from_sorted(items.begin(), items.end());
+  });
+  bench_build_row("from_sorted, slab", [&] {
+    return PooledAvlBst<int, int>::from_sorted(items.begin(), items.end());
+  });
+  bench_build_row("insert one by one", [&] {
+    AvlBst<int, int> tree;
+    for (auto const &item : items) tree.insert(item.first, item.second);
+    return tree;
+  });
+}
+
+// Порядковые запросы: k-й ключ и ранг ключа, время на один запрос. Для
+// сравнения k-й ключ ищется обходом итератором от begin()
+void bench_order_statistics() {
+  std::size_t const n = 1000000;
+  std::size_t const queries = 1000000;
+  std::size_t const walks = 100;
+  auto keys = shuffled_keys(n, 6);
+  auto probes = shuffled_keys(queries, 7);
+
+  std::printf("\n%-24s %12s %12s %12s\n", "10^6 random keys", "insert",
+              "k-th key", "rank");
+
+  long long sum = 0;
+  {
+    // Обычное дерево разрушается до построения рангового, чтобы оба
+    // строились в одинаковых условиях
+    AvlBst<int, int> plain;
+    double plain_ms = measure_ms([&] {
+      for (int k : keys) plain.insert(k, k);
+    });
+    double walk_ms = measure_ms([&] {
+      for (std::size_t q = 0; q < walks; q++) {
+        auto it = plain.begin();
+        for (auto i = static_cast<std::size_t>(probes[q]); i > 0; i--) ++it;
+        sum += *it;
+      }
+    });
+    std::printf("%-24s %9.2f ms %9.3f us %12s\n", "AvlBst, iteration",
+                plain_ms, walk_ms * 1000 / static_cast<double>(walks), "-");
+  }
+
+  RankedAvlBst<int, int> ranked;
+  double ranked_ms = measure_ms([&] {
+    for (int k : keys) ranked.insert(k, k);
+  });
+  double select_ms = measure_ms([&] {
+    for (int k : probes) sum += *ranked.select(static_cast<std::size_t>(k));
+  });
+  double rank_ms = measure_ms([&] {
+    for (int k : probes) sum += static_cast<long long>(ranked.rank(k));
+  });
+  sink = sum;
+  std::printf("%-24s %9.2f ms %9.3f us %9.3f us\n", "RankedAvlBst", ranked_ms,
+              select_ms * 1000 / static_cast<double>(queries),
+              rank_ms * 1000 / static_cast<double>(queries));
+}
+
+// Запросы по окну ключей [lo, lo + width): range() против полного обхода
+// с отбором по ключу. Время на один запрос
+void bench_range_scan() {
+  std::size_t const n = 1000000;
+  std::size_t const queries = 10000;
+  std::size_t const scans = 10;
+  int const width = 100;
+
+  AvlBst<int, int> tree;
+  for (int k : shuffled_keys(n, 8)) tree.insert(k, k);
+  auto starts = shuffled_keys(n - static_cast<std::size_t>(width), 9);
+
+  long long sum = 0;
+  double range_ms = measure_ms([&] {
+    for (std::size_t q = 0; q < queries; q++) {
+      for (int v : tree.range(starts[q], starts[q] + width)) sum += v;
+    }
+  });
+  double scan_ms = measure_ms([&] {
+    for (std::size_t q = 0; q < scans; q++) {
+      for (auto it = tree.begin(); it != tree.end(); ++it) {
+        if (it.key() >= starts[q] && it.key() < starts[q] + width) sum += *it;
+      }
+    }
+  });
+  sink = sum;
+
+  std::printf("\n%-24s %12s %12s\n", "10^6 keys, window 100", "range()",
+              "full scan");
+  std::printf("%-24s %9.3f us %9.3f us\n", "per query",
+              range_ms * 1000 / static_cast<double>(queries),
+              scan_ms * 1000 / static_cast<double>(scans));
+}
+
+// Дерево из n случайных ключей от 0 до range
+AvlBst<int, int> random_tree(std::size_t n, int range, unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> dist(0, range - 1);
+  AvlBst<int, int> tree;
+  for (std::size_t i = 0; i < n; i++) {
+    int k = dist(gen);
+    tree.insert(k, k);
+  }
+  return tree;
+}
+
+// Слияние индексов: вставка элементов одного дерева в другое по одному
+// против set_union, и удаление диапазона ключей
+void bench_set_operations() {
+  int const range = 4000000;
+  std::printf("\n%-24s %12s %12s %12s\n", "merge into 10^6 keys",
+              "insert loop", "set_union", "parallel");
+
+  for (std::size_t m : {1000u, 1000000u}) {
+    double times[3];
+    for (int variant = 0; variant < 3; variant++) {
+      auto big = random_tree(1000000, range, 10);
+      auto small = random_tree(m, range, 11);
+      times[variant] = measure_ms([&] {
+        if (variant == 0) {
+          for (auto it = small.begin(); it != small.end(); ++it) {
+            big.insert(it.key(), *it);
+          }
+        } else if (variant == 1) {
+          big.set_union(small);
+        } else {
+          big.parallel_set_union(small);
+        }
+      });
+      sink = static_cast<long long>(big.size());
+    }
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%zu keys", m);
+    std::printf("%-24s %9.2f ms %9.2f ms %9.2f ms\n", name, times[0],
+                times[1], times[2]);
+  }
+
+  std::printf("\n%-24s %12s %12s\n", "erase 10% of 10^6 keys",
+              "remove loop", "erase(lo, hi)");
+  auto tree = random_tree(1000000, range, 12);
+  auto copy = random_tree(1000000, range, 12);
+  int lo = range / 2;
+  int hi = lo + range / 10;
+  double remove_ms = measure_ms([&] {
+    for (auto it = tree.lower_bound(lo); it != tree.end() && it.key() < hi;) {
+      int k = it.key();
+      ++it;
+      tree.remove(k);
+    }
+  });
+  double erase_ms = measure_ms([&] { copy.erase(lo, hi); });
+  sink = static_cast<long long>(tree.size() + copy.size());
+  std::printf("%-24s %9.2f ms %9.2f ms\n", "", remove_ms, erase_ms);
+}
+
+// AvlBst под одним общим мьютексом — как разделяемый индекс сейчас
+struct LockedAvlBst {
+  std::mutex m;
+  AvlBst<int, int> tree;
+
+  bool contains(int k) {
+    std::lock_guard<std::mutex> lock(m);
+    return tree.find(k) != tree.end();
+  }
+  void insert(int k, int v) {
+    std::lock_guard<std::mutex> lock(m);
+    tree.insert(k, v);
+  }
+  void remove(int k) {
+    std::lock_guard<std::mutex> lock(m);
+    tree.remove(k);
+  }
+};
+
+// Каждый поток выполняет свою долю ops операций над ключами из [0, range):
+// read_percent процентов поисков, остальное поровну вставки и удаления.
+// Возвращает миллионы операций в секунду по всем потокам
+template <typename Tree>
+double tree_throughput(std::size_t threads, std::size_t ops, int range,
+                       unsigned read_percent) {
+  Tree tree;
+  for (int k = 0; k < range; k += 2) tree.insert(k, k);
+
+  std::size_t per_thread = ops / threads;
+  // Потоки складывают результаты сюда, в sink пишется один раз после join
+  std::atomic<long long> found_total{0};
+  double ms = measure_ms([&] {
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        std::mt19937 gen(static_cast<unsigned>(t) + 1);
+        std::uniform_int_distribution<int> key(0, range - 1);
+        std::uniform_int_distribution<unsigned> percent(0, 99);
+        long long found = 0;
+        for (std::size_t i = 0; i < per_thread; i++) {
+          int k = key(gen);
+          unsigned p = percent(gen);
+          if (p < read_percent) {
+            found += tree.contains(k);
+          } else if ((p - read_percent) % 2 == 0) {
+            tree.insert(k, k);
+          } else {
+            tree.remove(k);
+          }
+        }
+        found_total.fetch_add(found, std::memory_order_relaxed);
+      });
+    }
+    for (auto &w : workers) w.join();
+  });
+  sink = found_total.load();
+  return static_cast<double>(per_thread * threads) / ms / 1000.0;
+}
+
+// Общий индекс из 2^16 ключей: один мьютекс на всё дерево против
+// оптимистичных читателей и поузловых блокировок ConcurrentAvlBst
+void bench_concurrent_tree() {
+  std::size_t const ops = 2000000;
+  int const range = 1 << 16;
+
+  for (unsigned read_percent : {90u, 50u}) {
+    std::printf("\n%-10s %18s %18s %9s\n",
+                read_percent == 90 ? "90% reads" : "50% reads",
+                "mutex+AvlBst Mops/s", "concurrent Mops/s", "ratio");
+    for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+      double locked = tree_throughput<LockedAvlBst>(threads, ops, range,
+                                                    read_percent);
+      double concurrent = tree_throughput<ConcurrentAvlBst<int, int>>(
+          threads, ops, range, read_percent);
+      std::printf("%-10zu %18.2f %18.2f %8.2fx\n", threads, locked,
+                  concurrent, concurrent / locked);
+    }
+  }
+}
+
+// Аллокатор, считающий занятую узлами память. Счётчик общий для всех
+// rebind
+std::size_t live_bytes = 0;
+
+template <typename T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator() = default;
+  template <typename U>
+  counting_allocator(counting_allocator<U> const &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    live_bytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) noexcept {
+    live_bytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  bool operator==(counting_allocator const &) const noexcept { return true; }
+  bool operator!=(counting_allocator const &) const noexcept { return false; }
+};
+
+// Вставка, поиск и удаление 10^6 случайных ключей. snapshot_period > 0 —
+// каждые столько изменений снимается снимок, живущий до следующего, как у
+// читателя, которому раз за разом передают свежую версию
+template <typename Tree>
+void bench_versions_row(char const *name, std::size_t snapshot_period) {
+  auto keys = shuffled_keys(1000000, 13);
+  Tree tree;
+  Tree snapshot;
+  std::size_t writes = 0;
+  auto wrote = [&] {
+    if (snapshot_period != 0 && ++writes % snapshot_period == 0) {
+      snapshot = tree;
+    }
+  };
+
+  double insert_ms = measure_ms([&] {
+    for (int k : keys) {
+      tree.insert(k, k);
+      wrote();
+    }
+  });
+  long long sum = 0;
+  double find_ms = measure_ms([&] {
+    for (int k : keys) sum += *tree.find(k);
+  });
+  double remove_ms = measure_ms([&] {
+    for (int k : keys) {
+      tree.remove(k);
+      wrote();
+    }
+  });
+  sink = sum;
+
+  std::printf("%-32s %10.2f ms %10.2f ms %10.2f ms\n", name, insert_ms,
+              find_ms, remove_ms);
+}
+
+// Память и время: полная копия AvlBst против снимка PersistentAvlBst и
+// плата за копирование путей при изменениях
+void bench_persistent() {
+  using Mutable = AvlBst<int, int, counting_allocator<int>>;
+  using Persistent = PersistentAvlBst<int, int, counting_allocator<int>>;
+  std::size_t const n = 1000000;
+  std::size_t const updates = 100000;
+  auto keys = shuffled_keys(n, 14);
+  auto per_element = [n](std::size_t bytes) {
+    return static_cast<double>(bytes) / static_cast<double>(n);
+  };
+
+  std::printf("\n%-32s %13s %13s %13s\n", "10^6 keys, bytes per element",
+              "tree", "+ copy", "+ 10^5 upd.");
+  {
+    std::size_t before = live_bytes;
+    Mutable tree;
+    for (int k : keys) tree.insert(k, k);
+    std::size_t own = live_bytes - before;
+    double copy_ms = 0;
+    {
+      Mutable copy;
+      copy_ms = measure_ms([&] { copy = Mutable(tree); });
+      std::printf("%-32s %13.1f %13.1f %13s\n", "AvlBst + full copy",
+                  per_element(own), per_element(live_bytes - before - own),
+                  "-");
+    }
+    std::printf("%-32s %10.3f ms\n", "  copy time", copy_ms);
+  }
+  {
+    std::size_t before = live_bytes;
+    Persistent tree;
+    for (int k : keys) tree.insert(k, k);
+    std::size_t own = live_bytes - before;
+    Persistent snapshot;
+    double snapshot_ms = measure_ms([&] { snapshot = tree.snapshot(); });
+    std::size_t shared = live_bytes - before - own;
+
+    std::mt19937 gen(15);
+    std::uniform_int_distribution<int> key(0, static_cast<int>(n) - 1);
+    for (std::size_t i = 0; i < updates; i++) tree.insert(key(gen), -1);
+    std::printf("%-32s %13.1f %13.1f %13.1f\n", "PersistentAvlBst + snapshot",
+                per_element(own), per_element(shared),
+                per_element(live_bytes - before - own));
+    std::printf("%-32s %10.3f ms\n", "  snapshot time", snapshot_ms);
+  }
+
+  std::printf("\n%-32s %13s %13s %13s\n", "10^6 random keys", "insert",
+              "find", "remove");
+  bench_versions_row<AvlBst<int, int>>("AvlBst", 0);
+  bench_versions_row<PersistentAvlBst<int, int>>("PersistentAvlBst", 0);
+  bench_versions_row<PersistentAvlBst<int, int>>("  snapshot every 100 writes",
+                                                 100);
+  bench_versions_row<PersistentAvlBst<int, int>>("  snapshot every write", 1);
+}
+
+// Число вызовов компаратора в counted
+long long compare_calls = 0;
+
+// Прозрачное «меньше», для которого ниже задан поиск двумя сравнениями на
+// узел, как было до появления Compare
+struct two_way_less {
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(A const &a, B const &b) const {
+    return a < b;
+  }
+};
+
+// Компаратор Compare, считающий свои вызовы. compare есть, только если он
+// есть у Compare
+template <typename Compare>
+struct counted : Compare {
+  template <typename A, typename B>
+  bool operator()(A const &a, B const &b) const {
+    compare_calls++;
+    return Compare::operator()(a, b);
+  }
+
+  template <typename A, typename B, typename C = Compare>
+  auto compare(A const &a, B const &b) const
+      -> decltype(std::declval<C const &>().compare(a, b)) {
+    compare_calls++;
+    return Compare::compare(a, b);
+  }
+};
+
+}  // namespace
+
+template <typename Key>
+struct key_search_policy<Key, two_way_less>
+    : std::integral_constant<key_search, key_search::two_way> {};
+template <typename Key, typename Compare>
+struct key_search_policy<Key, counted<Compare>>
+    : key_search_policy<Key, Compare> {};
+
+namespace {
+
+template <typename Key>
+Key lookup_bench_key(int k) {
+  if constexpr (std::is_same_v<Key, std::string>) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "lookup-key-%012d", k);
+    return buf;
+  } else {
+    return static_cast<Key>(k);
+  }
+}
+
+// Среднее число вызовов компаратора и время на один поиск. Вызовы
+// считаются на отдельном дереве с counted<Compare>, чтобы счётчик не
+// влиял на время
+template <typename Key, typename Compare>
+void bench_lookup_row(char const *name, std::vector<Key> const &keys,
+                      std::vector<Key> const &probes) {
+  using Tree =
+      AvlBst<Key, int, std::allocator<std::pair<const Key, int>>, false,
+             Compare>;
+  using CountedTree =
+      AvlBst<Key, int, std::allocator<std::pair<const Key, int>>, false,
+             counted<Compare>>;
+  std::size_t const counted_probes = 100000;
+
+  Tree tree;
+  for (auto const &k : keys) tree.insert(k, 0);
+  long long found = 0;
+  double ms = measure_ms([&] {
+    for (auto const &p : probes) found += tree.find(p) != tree.end();
+  });
+
+  CountedTree counted_tree;
+  for (auto const &k : keys) counted_tree.insert(k, 0);
+  compare_calls = 0;
+  for (std::size_t i = 0; i < counted_probes; i++) {
+    found += counted_tree.find(probes[i]) != counted_tree.end();
+  }
+  sink = found;
+
+  std::printf("%-32s %13.1f %10.1f ns\n", name,
+              static_cast<double>(compare_calls) /
+                  static_cast<double>(counted_probes),
+              ms * 1e6 / static_cast<double>(probes.size()));
+}
+
+template <typename Key>
+void bench_lookup_key(char const *type, std::vector<int> const &keys,
+                      std::vector<int> const &probes) {
+  std::vector<Key> tree_keys;
+  for (int k : keys) tree_keys.push_back(lookup_bench_key<Key>(k));
+  std::vector<Key> tree_probes;
+  for (int p : probes) tree_probes.push_back(lookup_bench_key<Key>(p));
+
+  std::string name(type);
+  bench_lookup_row<Key, two_way_less>((name + ", two-way").c_str(),
+                                      tree_keys, tree_probes);
+  bench_lookup_row<Key, three_way_less>((name + ", three-way").c_str(),
+                                        tree_keys, tree_probes);
+  if constexpr (std::is_arithmetic_v<Key>) {
+    bench_lookup_row<Key, std::less<>>((name + ", branchless").c_str(),
+                                       tree_keys, tree_probes);
+  }
+}
+
+// Политики поиска: два сравнения на узел, одно трёхстороннее и спуск без
+// ветвлений. Ключи дерева чётные, так что половина поисков неудачна
+void bench_lookup_policies() {
+  std::size_t const n = 1 << 18;
+  std::size_t const lookups = 1000000;
+  std::vector<int> keys = shuffled_keys(n, 11);
+  for (int &k : keys) k *= 2;
+  std::vector<int> probes(lookups);
+  std::mt19937 gen(12);
+  std::uniform_int_distribution<int> probe(0, 2 * static_cast<int>(n) - 1);
+  for (int &p : probes) p = probe(gen);
+
+  std::printf("\n%-32s %13s %13s\n", "2^18 keys, 10^6 find()",
+              "compare/find", "time/find");
+  bench_lookup_key<int>("int", keys, probes);
+  bench_lookup_key<std::uint64_t>("uint64", keys, probes);
+  bench_lookup_key<std::string>("string", keys, probes);
+}
+
+}  // namespace
+
+int main() {
+  bench_iteration();
+  bench_orders();
+  bench_rebuild();
+  bench_bulk_load();
+  bench_order_statistics();
+  bench_range_scan();
+  bench_set_operations();
+  bench_concurrent_tree();
+  bench_persistent();
+  bench_lookup_policies();
+}
@@ -0,0 +1,784 @@
+#ifndef CONCURRENT_AVL_BSTREE_H_
+#define CONCURRENT_AVL_BSTREE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "../lab_1_list/epoch.h"
+
+/// АВЛ-дерево для одновременной работы многих потоков (схема Bronson и
+/// др., «A Practical Concurrent Binary Search Tree»).
+///
+/// Поиск не берёт блокировок. У каждого узла есть версия, которая
+/// меняется, когда из поддерева узла уходят ключи (узел опускается
+/// поворотом) или узел исключается из дерева. Читатель спускается, помня
+/// версию текущего узла: прочитав ссылку на сына, он сверяет версию и при
+/// расхождении повторяет шаг с уровня выше, а не от корня.
+///
+/// Писатель блокирует только изменяемые узлы: вставка — отца нового
+/// листа, удаление — узел и его отца, поворот — отца, узел и поднимаемых
+/// сыновей. Блокировки берутся сверху вниз, а необходимость поворота
+/// перепроверяется уже под ними.
+///
+/// Баланс ослабленный: высоты уточняются и повороты выполняются после
+/// изменения, отдельными шагами на пути к корню, поэтому при конкуренции
+/// дерево бывает временно несбалансировано. Удаление узла с двумя сыновьями
+/// лишь снимает с него данные; такой маршрутный узел исключается позже,
+/// когда у него останется не больше одного сына.
+///
+/// Исключённые узлы и заменённые данные освобождаются через epoch_domain,
+/// так что читатель не обращается к освобождённой памяти. Данные хранятся
+/// в отдельном неизменяемом объекте, и get возвращает их копию
+template <typename T_key, typename T_data>
+class ConcurrentAvlBst {
+  struct Link;
+  struct Node;
+
+ public:
+  using key_type = T_key;
+  using value_type = T_data;
+  using size_type = std::size_t;
+
+ public:
+  ConcurrentAvlBst() : domain_(epoch_domain::instance()){};
+  ConcurrentAvlBst(ConcurrentAvlBst const &) = delete;
+  ConcurrentAvlBst &operator=(ConcurrentAvlBst const &) = delete;
+  // Дерево не должно использоваться другими потоками
+  ~ConcurrentAvlBst();
+
+  // копия данных по ключу или пустое значение. Без блокировок
+  std::optional<value_type> get(key_type const &k) const;
+  bool contains(key_type const &k) const;
+
+  // включение или замена данных; v переносится в дерево
+  void insert(key_type const &k, value_type v);
+  bool remove(key_type const &k);  // удаление; false, если ключа не было
+
+  size_type size() const noexcept;  // размер дерева (мгновенный снимок)
+  bool empty() const noexcept;      // проверка дерева на пустоту
+
+  // высота дерева по данным корня. Точна, когда дерево не изменяется
+  size_type height() const noexcept;
+
+ private:
+  // Версия узла: бит 0 — узел исключён, бит 1 — идёт поворот, при котором
+  // ключи уходят из поддерева узла, старшие биты — счётчик поворотов
+  using version_type = std::uint64_t;
+  static constexpr version_type unlinked = 1;
+  static constexpr version_type shrinking = 2;
+  static constexpr version_type version_step = 4;
+
+  // Сколько раз читатель перечитывает версию, прежде чем дождаться конца
+  // поворота на блокировке узла
+  static constexpr int spin_limit = 100;
+
+  // Результаты node_condition, кроме новой высоты узла
+  static constexpr int nothing_required = -1;
+  static constexpr int rebalance_required = -2;
+  static constexpr int unlink_required = -3;
+
+  // Результат попытки на одном уровне спуска: retry — версия узла
+  // изменилась, и шаг повторяется с предыдущего уровня
+  enum class Attempt { Done, Retry };
+
+  // Всё, кроме ключа. Заголовок holder_ — тоже Link: корень дерева — его
+  // правый сын, и замена корня ничем не отличается от замены сына
+  struct Link {
+    std::atomic<value_type *> value{nullptr};  // nullptr — маршрутный узел
+    std::atomic<int> height{0};
+    std::atomic<version_type> version{0};
+    std::atomic<Link *> parent{nullptr};
+    std::atomic<Node *> left{nullptr};
+    std::atomic<Node *> right{nullptr};
+    std::mutex lock;
+
+    std::atomic<Node *> &child(int dir) { return dir < 0 ? left : right; }
+  };
+
+  struct Node : Link {
+    key_type const key;
+
+    Node(key_type const &k, value_type *v, Link *p) : key(k) {
+      this->value.store(v, std::memory_order_relaxed);
+      this->height.store(1, std::memory_order_relaxed);
+      this->parent.store(p, std::memory_order_relaxed);
+    }
+  };
+
+  static int compare(key_type const &k, key_type const &key) noexcept;
+  static int height(Node *node) noexcept;
+  static void wait_until_not_changing(Link *node);
+
+  // Спуск от сына dir узла node, версия которого была node_version.
+  // fresh — новые данные, nullptr при удалении; в prev — прежние данные
+  Attempt attempt_get(key_type const &k, Link *node, int dir,
+                      version_type node_version, value_type *&found) const;
+  Attempt attempt_update(key_type const &k, value_type *fresh, Link *node,
+                         int dir, version_type node_version,
+                         value_type *&prev);
+  Attempt attempt_node_update(value_type *fresh, Link *parent, Node *node,
+                              value_type *&prev);
+
+  // Досбалансировка на пути от node к корню
+  void fix_height_and_rebalance(Link *node);
+  static int node_condition(Link *node);
+
+  // Функции с суффиксом _locked и повороты вызываются под блокировками
+  // узла и его отца. Возвращают следующий узел, требующий починки, или
+  // nullptr
+  Link *fix_height_locked(Link *node);
+  Link *rebalance_locked(Link *parent, Node *n);
+  Link *rebalance_to_right_locked(Link *parent, Node *n, Node *nl, int hr0);
+  Link *rebalance_to_left_locked(Link *parent, Node *n, Node *nr, int hl0);
+  bool unlink_locked(Link *parent, Node *n);
+  Link *finish_rotation(Link *parent, Node *top);
+
+  Link *right_rotate(Link *parent, Node *n, Node *nl, int hr, int hll,
+                     Node *nlr, int hlr);
+  Link *left_rotate(Link *parent, Node *n, Node *nr, int hl, int hrr,
+                    Node *nrl, int hrl);
+  Link *double_right_rotate(Link *parent, Node *n, Node *nl, int hr, int hll,
+                            Node *nlr, int hlrl);
+  Link *double_left_rotate(Link *parent, Node *n, Node *nr, int hl, int hrr,
+                           Node *nrl, int hrlr);
+
+  epoch_domain &domain_;
+  // Версия заголовка не меняется: поиск от него никогда не повторяется
+  mutable Link holder_;
+  std::atomic<size_type> size_{0};
+};
+
+template <typename T_key, typename T_data>
+ConcurrentAvlBst<T_key, T_data>::~ConcurrentAvlBst() {
+  // Левые сыновья поворотами переносятся на правую цепочку, которая
+  // удаляется по одному узлу без стека
+  Node *node = holder_.right.load(std::memory_order_relaxed);
+  while (node != nullptr) {
+    Node *left = node->left.load(std::memory_order_relaxed);
+    if (left != nullptr) {
+      node->left.store(left->right.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+      left->right.store(node, std::memory_order_relaxed);
+      node = left;
+    } else {
+      Node *right = node->right.load(std::memory_order_relaxed);
+      delete node->value.load(std::memory_order_relaxed);
+      delete node;
+      node = right;
+    }
+  }
+}
+
+template <typename T_key, typename T_data>
+int ConcurrentAvlBst<T_key, T_data>::compare(key_type const &k,
+                                             key_type const &key) noexcept {
+  if (k < key) return -1;
+  if (key < k) return 1;
+  return 0;
+}
+
+template <typename T_key, typename T_data>
+int ConcurrentAvlBst<T_key, T_data>::height(Node *node) noexcept {
+  return node == nullptr ? 0 : node->height.load(std::memory_order_relaxed);
+}
+
+template <typename T_key, typename T_data>
+void ConcurrentAvlBst<T_key, T_data>::wait_until_not_changing(Link *node) {
+  version_type version = node->version.load(std::memory_order_acquire);
+  if ((version & shrinking) == 0) return;
+
+  for (int i = 0; i < spin_limit; i++) {
+    if (node->version.load(std::memory_order_acquire) != version) return;
+  }
+  // Поворот идёт под блокировкой узла: дожидаемся её снятия
+  std::lock_guard<std::mutex> lock(node->lock);
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Attempt
+ConcurrentAvlBst<T_key, T_data>::attempt_get(key_type const &k, Link *node,
+                                             int dir,
+                                             version_type node_version,
+                                             value_type *&found) const {
+  while (true) {
+    Node *child = node->child(dir).load(std::memory_order_acquire);
+    if (node->version.load(std::memory_order_acquire) != node_version)
+      return Attempt::Retry;
+
+    if (child == nullptr) {
+      found = nullptr;
+      return Attempt::Done;
+    }
+    int c = compare(k, child->key);
+    if (c == 0) {
+      found = child->value.load(std::memory_order_acquire);
+      return Attempt::Done;
+    }
+
+    version_type child_version =
+        child->version.load(std::memory_order_acquire);
+    if (child_version & (shrinking | unlinked)) {
+      wait_until_not_changing(child);
+    } else if (child == node->child(dir).load(std::memory_order_acquire)) {
+      if (node->version.load(std::memory_order_acquire) != node_version)
+        return Attempt::Retry;
+      if (attempt_get(k, child, c, child_version, found) == Attempt::Done)
+        return Attempt::Done;
+    }
+    // иначе сын уже сменился или спуск ниже не удался — повтор шага
+  }
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Attempt
+ConcurrentAvlBst<T_key, T_data>::attempt_update(key_type const &k,
+                                                value_type *fresh, Link *node,
+                                                int dir,
+                                                version_type node_version,
+                                                value_type *&prev) {
+  while (true) {
+    Node *child = node->child(dir).load(std::memory_order_acquire);
+    if (node->version.load(std::memory_order_acquire) != node_version)
+      return Attempt::Retry;
+
+    if (child == nullptr) {
+      prev = nullptr;
+      if (fresh == nullptr) return Attempt::Done;  // удалять нечего
+
+      Link *damaged = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(node->lock);
+        if (node->version.load(std::memory_order_relaxed) != node_version)
+          return Attempt::Retry;
+        if (node->child(dir).load(std::memory_order_relaxed) != nullptr)
+          continue;  // место уже занято другим писателем
+
+        // Узел создаётся целиком и лишь затем публикуется
+        node->child(dir).store(new Node(k, fresh, node),
+                               std::memory_order_release);
+        damaged = fix_height_locked(node);
+      }
+      fix_height_and_rebalance(damaged);
+      return Attempt::Done;
+    }
+
+    version_type child_version =
+        child->version.load(std::memory_order_acquire);
+    if (child_version & (shrinking | unlinked)) {
+      wait_until_not_changing(child);
+    } else if (child == node->child(dir).load(std::memory_order_acquire)) {
+      if (node->version.load(std::memory_order_acquire) != node_version)
+        return Attempt::Retry;
+
+      int c = compare(k, child->key);
+      Attempt result =
+          c == 0 ? attempt_node_update(fresh, node, child, prev)
+                 : attempt_update(k, fresh, child, c, child_version, prev);
+      if (result == Attempt::Done) return Attempt::Done;
+    }
+  }
+}
+
+// Замена или снятие данных найденного узла. Узел, у которого не больше
+// одного сына, при удалении исключается из дерева
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Attempt
+ConcurrentAvlBst<T_key, T_data>::attempt_node_update(value_type *fresh,
+                                                     Link *parent, Node *node,
+                                                     value_type *&prev) {
+  if (fresh == nullptr) {
+    if (node->value.load(std::memory_order_acquire) == nullptr) {
+      prev = nullptr;
+      return Attempt::Done;
+    }
+
+    if (node->left.load(std::memory_order_acquire) == nullptr ||
+        node->right.load(std::memory_order_acquire) == nullptr) {
+      Link *damaged = nullptr;
+      {
+        std::lock_guard<std::mutex> parent_lock(parent->lock);
+        if ((parent->version.load(std::memory_order_relaxed) & unlinked) ||
+            node->parent.load(std::memory_order_relaxed) != parent)
+          return Attempt::Retry;
+
+        std::lock_guard<std::mutex> node_lock(node->lock);
+        prev = node->value.load(std::memory_order_relaxed);
+        if (prev == nullptr) return Attempt::Done;
+        if (!unlink_locked(parent, node)) return Attempt::Retry;
+        damaged = fix_height_locked(parent);
+      }
+      fix_height_and_rebalance(damaged);
+      return Attempt::Done;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(node->lock);
+  if (node->version.load(std::memory_order_relaxed) & unlinked)
+    return Attempt::Retry;
+
+  // У узла мог остаться один сын: тогда его нужно исключать, а не
+  // превращать в маршрутный
+  if (fresh == nullptr &&
+      (node->left.load(std::memory_order_relaxed) == nullptr ||
+       node->right.load(std::memory_order_relaxed) == nullptr))
+    return Attempt::Retry;
+
+  prev = node->value.load(std::memory_order_relaxed);
+  node->value.store(fresh, std::memory_order_release);
+  return Attempt::Done;
+}
+
+template <typename T_key, typename T_data>
+void ConcurrentAvlBst<T_key, T_data>::fix_height_and_rebalance(Link *node) {
+  while (node != nullptr &&
+         node->parent.load(std::memory_order_acquire) != nullptr) {
+    int condition = node_condition(node);
+    if (condition == nothing_required ||
+        (node->version.load(std::memory_order_acquire) & unlinked))
+      return;
+
+    if (condition != unlink_required && condition != rebalance_required) {
+      std::lock_guard<std::mutex> lock(node->lock);
+      node = fix_height_locked(node);
+    } else {
+      Link *parent = node->parent.load(std::memory_order_acquire);
+      std::lock_guard<std::mutex> parent_lock(parent->lock);
+      if ((parent->version.load(std::memory_order_relaxed) & unlinked) == 0 &&
+          node->parent.load(std::memory_order_relaxed) == parent) {
+        std::lock_guard<std::mutex> node_lock(node->lock);
+        node = rebalance_locked(parent, static_cast<Node *>(node));
+      }
+    }
+  }
+}
+
+// Что нужно узлу: исключение маршрутного узла, поворот, новая высота
+// (возвращается она сама) или ничего
+template <typename T_key, typename T_data>
+int ConcurrentAvlBst<T_key, T_data>::node_condition(Link *node) {
+  Node *nl = node->left.load(std::memory_order_acquire);
+  Node *nr = node->right.load(std::memory_order_acquire);
+  if ((nl == nullptr || nr == nullptr) &&
+      node->value.load(std::memory_order_acquire) == nullptr)
+    return unlink_required;
+
+  int hn = node->height.load(std::memory_order_relaxed);
+  int hl = height(nl);
+  int hr = height(nr);
+  int hn_repl = 1 + std::max(hl, hr);
+  int balance = hl - hr;
+
+  if (balance < -1 || balance > 1) return rebalance_required;
+  return hn != hn_repl ? hn_repl : nothing_required;
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::fix_height_locked(Link *node) {
+  int condition = node_condition(node);
+  switch (condition) {
+    case rebalance_required:
+    case unlink_required:
+      return node;
+    case nothing_required:
+      return nullptr;
+    default:
+      node->height.store(condition, std::memory_order_relaxed);
+      return node->parent.load(std::memory_order_relaxed);
+  }
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::rebalance_locked(Link *parent, Node *n) {
+  Node *nl = n->left.load(std::memory_order_relaxed);
+  Node *nr = n->right.load(std::memory_order_relaxed);
+
+  if ((nl == nullptr || nr == nullptr) &&
+      n->value.load(std::memory_order_relaxed) == nullptr) {
+    if (unlink_locked(parent, n)) return fix_height_locked(parent);
+    return n;
+  }
+
+  int hn = n->height.load(std::memory_order_relaxed);
+  int hl0 = height(nl);
+  int hr0 = height(nr);
+  int hn_repl = 1 + std::max(hl0, hr0);
+  int balance = hl0 - hr0;
+
+  if (balance > 1) return rebalance_to_right_locked(parent, n, nl, hr0);
+  if (balance < -1) return rebalance_to_left_locked(parent, n, nr, hl0);
+  if (hn_repl != hn) {
+    n->height.store(hn_repl, std::memory_order_relaxed);
+    return fix_height_locked(parent);
+  }
+  return nullptr;
+}
+
+// Левое поддерево выше правого на 2 и больше. Высоты сыновей прочитаны без
+// их блокировок, поэтому под блокировкой nl перепроверяются: если перекоса
+// уже нет, возвращается n, и его состояние оценивается заново
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::rebalance_to_right_locked(Link *parent,
+                                                           Node *n, Node *nl,
+                                                           int hr0) {
+  std::lock_guard<std::mutex> left_lock(nl->lock);
+  int hl = nl->height.load(std::memory_order_relaxed);
+  if (hl - hr0 <= 1) return n;
+
+  Node *nlr = nl->right.load(std::memory_order_relaxed);
+  int hll0 = height(nl->left.load(std::memory_order_relaxed));
+  int hlr0 = height(nlr);
+  if (hll0 >= hlr0) return right_rotate(parent, n, nl, hr0, hll0, nlr, hlr0);
+
+  {
+    std::lock_guard<std::mutex> left_right_lock(nlr->lock);
+    int hlr = nlr->height.load(std::memory_order_relaxed);
+    if (hll0 >= hlr) return right_rotate(parent, n, nl, hr0, hll0, nlr, hlr);
+
+    int hlrl = height(nlr->left.load(std::memory_order_relaxed));
+    int balance = hll0 - hlrl;
+    if (balance >= -1 && balance <= 1)
+      return double_right_rotate(parent, n, nl, hr0, hll0, nlr, hlrl);
+  }
+  // Двойной поворот оставил бы nl несбалансированным: сначала nl
+  // поворачивается влево, затем n оценивается заново
+  return rebalance_to_left_locked(n, nl, nlr, hll0);
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::rebalance_to_left_locked(Link *parent,
+                                                          Node *n, Node *nr,
+                                                          int hl0) {
+  std::lock_guard<std::mutex> right_lock(nr->lock);
+  int hr = nr->height.load(std::memory_order_relaxed);
+  if (hl0 - hr >= -1) return n;
+
+  Node *nrl = nr->left.load(std::memory_order_relaxed);
+  int hrl0 = height(nrl);
+  int hrr0 = height(nr->right.load(std::memory_order_relaxed));
+  if (hrr0 >= hrl0) return left_rotate(parent, n, nr, hl0, hrr0, nrl, hrl0);
+
+  {
+    std::lock_guard<std::mutex> right_left_lock(nrl->lock);
+    int hrl = nrl->height.load(std::memory_order_relaxed);
+    if (hrr0 >= hrl) return left_rotate(parent, n, nr, hl0, hrr0, nrl, hrl);
+
+    int hrlr = height(nrl->right.load(std::memory_order_relaxed));
+    int balance = hrr0 - hrlr;
+    if (balance >= -1 && balance <= 1)
+      return double_left_rotate(parent, n, nr, hl0, hrr0, nrl, hrlr);
+  }
+  return rebalance_to_right_locked(n, nr, nrl, hrr0);
+}
+
+// Исключение узла, у которого не больше одного сына. Узел помечается
+// исключённым, а освобождается, когда его не смогут видеть читатели
+template <typename T_key, typename T_data>
+bool ConcurrentAvlBst<T_key, T_data>::unlink_locked(Link *parent, Node *n) {
+  Node *parent_left = parent->left.load(std::memory_order_relaxed);
+  Node *parent_right = parent->right.load(std::memory_order_relaxed);
+  if (parent_left != n && parent_right != n) return false;
+
+  Node *left = n->left.load(std::memory_order_relaxed);
+  Node *right = n->right.load(std::memory_order_relaxed);
+  if (left != nullptr && right != nullptr) return false;
+
+  Node *splice = left != nullptr ? left : right;
+  if (parent_left == n) {
+    parent->left.store(splice, std::memory_order_release);
+  } else {
+    parent->right.store(splice, std::memory_order_release);
+  }
+  if (splice != nullptr)
+    splice->parent.store(parent, std::memory_order_release);
+
+  n->version.store(unlinked, std::memory_order_release);
+  n->value.store(nullptr, std::memory_order_relaxed);
+  domain_.retire(n);
+  return true;
+}
+
+// Окончание поворота: top — новая вершина поддерева под parent. Маршрутный
+// top без одного из сыновей исключается сразу, при нарушении баланса
+// чинится top, иначе — высота parent
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::finish_rotation(Link *parent, Node *top) {
+  int condition = node_condition(top);
+  if (condition == rebalance_required) return top;
+  if (condition == unlink_required && !unlink_locked(parent, top)) return top;
+  return fix_height_locked(parent);
+}
+
+// Поворот n вправо: nl становится сыном parent. Ключи уходят из поддерева
+// n, поэтому на время поворота его версия помечается shrinking, и читатель,
+// успевший спуститься в n, повторит шаг
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::right_rotate(Link *parent, Node *n, Node *nl,
+                                              int hr, int hll, Node *nlr,
+                                              int hlr) {
+  version_type version = n->version.load(std::memory_order_relaxed);
+  Node *parent_left = parent->left.load(std::memory_order_relaxed);
+
+  n->version.store(version | shrinking, std::memory_order_release);
+
+  n->left.store(nlr, std::memory_order_release);
+  if (nlr != nullptr) nlr->parent.store(n, std::memory_order_release);
+  nl->right.store(n, std::memory_order_release);
+  n->parent.store(nl, std::memory_order_release);
+  if (parent_left == n) {
+    parent->left.store(nl, std::memory_order_release);
+  } else {
+    parent->right.store(nl, std::memory_order_release);
+  }
+  nl->parent.store(parent, std::memory_order_release);
+
+  int hn_repl = 1 + std::max(hlr, hr);
+  n->height.store(hn_repl, std::memory_order_relaxed);
+  nl->height.store(1 + std::max(hll, hn_repl), std::memory_order_relaxed);
+
+  n->version.store(version + version_step, std::memory_order_release);
+
+  // Маршрутный n, оставшийся с одним сыном, исключается сразу: его новый
+  // отец nl тоже заблокирован
+  if (n->value.load(std::memory_order_relaxed) == nullptr &&
+      unlink_locked(nl, n)) {
+    nl->height.store(
+        1 + std::max(hll, height(nl->right.load(std::memory_order_relaxed))),
+        std::memory_order_relaxed);
+  } else if (hlr - hr < -1 || hlr - hr > 1) {
+    return n;
+  }
+  return finish_rotation(parent, nl);
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::left_rotate(Link *parent, Node *n, Node *nr,
+                                             int hl, int hrr, Node *nrl,
+                                             int hrl) {
+  version_type version = n->version.load(std::memory_order_relaxed);
+  Node *parent_left = parent->left.load(std::memory_order_relaxed);
+
+  n->version.store(version | shrinking, std::memory_order_release);
+
+  n->right.store(nrl, std::memory_order_release);
+  if (nrl != nullptr) nrl->parent.store(n, std::memory_order_release);
+  nr->left.store(n, std::memory_order_release);
+  n->parent.store(nr, std::memory_order_release);
+  if (parent_left == n) {
+    parent->left.store(nr, std::memory_order_release);
+  } else {
+    parent->right.store(nr, std::memory_order_release);
+  }
+  nr->parent.store(parent, std::memory_order_release);
+
+  int hn_repl = 1 + std::max(hl, hrl);
+  n->height.store(hn_repl, std::memory_order_relaxed);
+  nr->height.store(1 + std::max(hn_repl, hrr), std::memory_order_relaxed);
+
+  n->version.store(version + version_step, std::memory_order_release);
+
+  if (n->value.load(std::memory_order_relaxed) == nullptr &&
+      unlink_locked(nr, n)) {
+    nr->height.store(
+        1 + std::max(height(nr->left.load(std::memory_order_relaxed)), hrr),
+        std::memory_order_relaxed);
+  } else if (hrl - hl < -1 || hrl - hl > 1) {
+    return n;
+  }
+  return finish_rotation(parent, nr);
+}
+
+// Двойной поворот: nlr поднимается на место n, а n и nl становятся его
+// сыновьями. Ключи уходят из поддеревьев и n, и nl. Вызывается и под
+// блокировкой nlr
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::double_right_rotate(Link *parent, Node *n,
+                                                     Node *nl, int hr,
+                                                     int hll, Node *nlr,
+                                                     int hlrl) {
+  version_type version = n->version.load(std::memory_order_relaxed);
+  version_type left_version = nl->version.load(std::memory_order_relaxed);
+  Node *parent_left = parent->left.load(std::memory_order_relaxed);
+  Node *nlrl = nlr->left.load(std::memory_order_relaxed);
+  Node *nlrr = nlr->right.load(std::memory_order_relaxed);
+  int hlrr = height(nlrr);
+
+  n->version.store(version | shrinking, std::memory_order_release);
+  nl->version.store(left_version | shrinking, std::memory_order_release);
+
+  n->left.store(nlrr, std::memory_order_release);
+  if (nlrr != nullptr) nlrr->parent.store(n, std::memory_order_release);
+  nl->right.store(nlrl, std::memory_order_release);
+  if (nlrl != nullptr) nlrl->parent.store(nl, std::memory_order_release);
+  nlr->left.store(nl, std::memory_order_release);
+  nl->parent.store(nlr, std::memory_order_release);
+  nlr->right.store(n, std::memory_order_release);
+  n->parent.store(nlr, std::memory_order_release);
+  if (parent_left == n) {
+    parent->left.store(nlr, std::memory_order_release);
+  } else {
+    parent->right.store(nlr, std::memory_order_release);
+  }
+  nlr->parent.store(parent, std::memory_order_release);
+
+  int hn_repl = 1 + std::max(hlrr, hr);
+  n->height.store(hn_repl, std::memory_order_relaxed);
+  int hl_repl = 1 + std::max(hll, hlrl);
+  nl->height.store(hl_repl, std::memory_order_relaxed);
+  nlr->height.store(1 + std::max(hl_repl, hn_repl), std::memory_order_relaxed);
+
+  n->version.store(version + version_step, std::memory_order_release);
+  nl->version.store(left_version + version_step, std::memory_order_release);
+
+  // Маршрутные n и nl, оставшиеся с одним сыном, исключаются сразу: их
+  // новый отец nlr тоже заблокирован. Иначе чинить пришлось бы оба узла, а
+  // они не лежат на одном пути к корню
+  bool n_unlinked = n->value.load(std::memory_order_relaxed) == nullptr &&
+                    unlink_locked(nlr, n);
+  bool nl_unlinked = nl->value.load(std::memory_order_relaxed) == nullptr &&
+                     unlink_locked(nlr, nl);
+  if (n_unlinked || nl_unlinked) {
+    nlr->height.store(
+        1 + std::max(height(nlr->left.load(std::memory_order_relaxed)),
+                     height(nlr->right.load(std::memory_order_relaxed))),
+        std::memory_order_relaxed);
+  }
+
+  if (!n_unlinked && (hlrr - hr < -1 || hlrr - hr > 1)) return n;
+  if (!nl_unlinked && (hll - hlrl < -1 || hll - hlrl > 1)) return nl;
+  return finish_rotation(parent, nlr);
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::Link *
+ConcurrentAvlBst<T_key, T_data>::double_left_rotate(Link *parent, Node *n,
+                                                    Node *nr, int hl, int hrr,
+                                                    Node *nrl, int hrlr) {
+  version_type version = n->version.load(std::memory_order_relaxed);
+  version_type right_version = nr->version.load(std::memory_order_relaxed);
+  Node *parent_left = parent->left.load(std::memory_order_relaxed);
+  Node *nrll = nrl->left.load(std::memory_order_relaxed);
+  Node *nrlr = nrl->right.load(std::memory_order_relaxed);
+  int hrll = height(nrll);
+
+  n->version.store(version | shrinking, std::memory_order_release);
+  nr->version.store(right_version | shrinking, std::memory_order_release);
+
+  n->right.store(nrll, std::memory_order_release);
+  if (nrll != nullptr) nrll->parent.store(n, std::memory_order_release);
+  nr->left.store(nrlr, std::memory_order_release);
+  if (nrlr != nullptr) nrlr->parent.store(nr, std::memory_order_release);
+  nrl->right.store(nr, std::memory_order_release);
+  nr->parent.store(nrl, std::memory_order_release);
+  nrl->left.store(n, std::memory_order_release);
+  n->parent.store(nrl, std::memory_order_release);
+  if (parent_left == n) {
+    parent->left.store(nrl, std::memory_order_release);
+  } else {
+    parent->right.store(nrl, std::memory_order_release);
+  }
+  nrl->parent.store(parent, std::memory_order_release);
+
+  int hn_repl = 1 + std::max(hl, hrll);
+  n->height.store(hn_repl, std::memory_order_relaxed);
+  int hr_repl = 1 + std::max(hrlr, hrr);
+  nr->height.store(hr_repl, std::memory_order_relaxed);
+  nrl->height.store(1 + std::max(hn_repl, hr_repl), std::memory_order_relaxed);
+
+  n->version.store(version + version_step, std::memory_order_release);
+  nr->version.store(right_version + version_step, std::memory_order_release);
+
+  bool n_unlinked = n->value.load(std::memory_order_relaxed) == nullptr &&
+                    unlink_locked(nrl, n);
+  bool nr_unlinked = nr->value.load(std::memory_order_relaxed) == nullptr &&
+                     unlink_locked(nrl, nr);
+  if (n_unlinked || nr_unlinked) {
+    nrl->height.store(
+        1 + std::max(height(nrl->left.load(std::memory_order_relaxed)),
+                     height(nrl->right.load(std::memory_order_relaxed))),
+        std::memory_order_relaxed);
+  }
+
+  if (!n_unlinked && (hrll - hl < -1 || hrll - hl > 1)) return n;
+  if (!nr_unlinked && (hrr - hrlr < -1 || hrr - hrlr > 1)) return nr;
+  return finish_rotation(parent, nrl);
+}
+
+template <typename T_key, typename T_data>
+std::optional<typename ConcurrentAvlBst<T_key, T_data>::value_type>
+ConcurrentAvlBst<T_key, T_data>::get(key_type const &k) const {
+  auto guard = domain_.pin();
+  value_type *found = nullptr;
+  attempt_get(k, &holder_, 1, 0, found);
+  if (found == nullptr) return std::nullopt;
+  return *found;
+}
+
+template <typename T_key, typename T_data>
+bool ConcurrentAvlBst<T_key, T_data>::contains(key_type const &k) const {
+  auto guard = domain_.pin();
+  value_type *found = nullptr;
+  attempt_get(k, &holder_, 1, 0, found);
+  return found != nullptr;
+}
+
+template <typename T_key, typename T_data>
+void ConcurrentAvlBst<T_key, T_data>::insert(key_type const &k,
+                                             value_type v) {
+  auto guard = domain_.pin();
+  std::unique_ptr<value_type> fresh(new value_type(std::move(v)));
+  value_type *prev = nullptr;
+  attempt_update(k, fresh.get(), &holder_, 1, 0, prev);
+  fresh.release();
+
+  if (prev != nullptr) {
+    domain_.retire(prev);
+  } else {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <typename T_key, typename T_data>
+bool ConcurrentAvlBst<T_key, T_data>::remove(key_type const &k) {
+  auto guard = domain_.pin();
+  value_type *prev = nullptr;
+  attempt_update(k, nullptr, &holder_, 1, 0, prev);
+  if (prev == nullptr) return false;
+
+  domain_.retire(prev);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::size_type
+ConcurrentAvlBst<T_key, T_data>::size() const noexcept {
+  return size_.load(std::memory_order_relaxed);
+}
+
+template <typename T_key, typename T_data>
+bool ConcurrentAvlBst<T_key, T_data>::empty() const noexcept {
+  return size() == 0;
+}
+
+template <typename T_key, typename T_data>
+typename ConcurrentAvlBst<T_key, T_data>::size_type
+ConcurrentAvlBst<T_key, T_data>::height() const noexcept {
+  return static_cast<size_type>(
+      height(holder_.right.load(std::memory_order_acquire)));
+}
+
+#endif  // CONCURRENT_AVL_BSTREE_H_
@@ -0,0 +1,543 @@
+#ifndef PERSISTENT_AVL_BSTREE_H_
+#define PERSISTENT_AVL_BSTREE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/// Персистентное АВЛ-дерево. Узлы разделяются между версиями и считают
+/// ссылки на себя; копия дерева и snapshot() лишь увеличивают счётчик
+/// корня, т.е. занимают O(1).
+///
+/// insert и remove не меняют разделяемые узлы, а копируют путь от корня
+/// до изменяемого места (O(log n) узлов); остальные поддеревья новая
+/// версия разделяет со старыми. Узел, на который ссылается только эта
+/// версия, меняется на месте, так что без снимков дерево работает как
+/// обычное, без копирования.
+///
+/// Снимок — самостоятельное дерево: его можно передать другому потоку и
+/// читать сколько угодно долго, писатель при этом не ждёт читателей.
+/// Счётчики ссылок атомарные, поэтому версии можно изменять и удалять в
+/// разных потоках; один и тот же объект дерева, как и прочие контейнеры,
+/// из нескольких потоков сразу не изменяется. Освобождать узлы может любой
+/// поток, поэтому аллокатор должен это допускать (slab_allocator — нет).
+///
+/// Родителей узлы не хранят (у разделяемого узла их несколько), поэтому
+/// итератор держит стек пути от корня
+template <typename T_key, typename T_data,
+          typename Alloc = std::allocator<std::pair<const T_key, T_data>>>
+class PersistentAvlBst {
+  class PersistentIterator;
+  struct Node;
+
+ public:
+  using key_type = T_key;
+  using value_type = T_data;
+  using const_reference = value_type const &;
+  using iterator = PersistentIterator;
+  using const_iterator = PersistentIterator;
+  using size_type = std::size_t;
+  using allocator_type = Alloc;
+
+ public:
+  PersistentAvlBst() : PersistentAvlBst(allocator_type()){};
+  explicit PersistentAvlBst(allocator_type const &a) : alloc_(a){};
+  PersistentAvlBst(PersistentAvlBst const &b);  // разделяет узлы b, O(1)
+  PersistentAvlBst(PersistentAvlBst &&b) noexcept;
+  ~PersistentAvlBst() { clear(); };
+
+  PersistentAvlBst &operator=(PersistentAvlBst const &b);
+  PersistentAvlBst &operator=(PersistentAvlBst &&b) noexcept;
+
+  // неизменная в дальнейшем версия дерева на текущий момент, O(1)
+  PersistentAvlBst snapshot() const { return *this; }
+
+  void swap(PersistentAvlBst &other) noexcept;  // обмен содержимым
+
+  size_type size() const noexcept;  // размер дерева
+  void clear() noexcept;            // очистка дерева
+  bool empty() const noexcept;      // проверка дерева на пустоту
+
+  // Поиск, как и в AvlBst, принимает ключ любого типа K, сравнимого с
+  // key_type операцией < в обе стороны (std::string_view для std::string)
+
+  // доступ по чтению к данным
+  template <typename K = key_type>
+  const_reference at(K const &k) const;
+
+  // Включение и удаление копируют путь от корня, если он разделяется с
+  // другими версиями. Трудоёмкость – O (log n)
+  // включение данных с заданным ключом
+  void insert(key_type const &k, value_type const &v);
+  void remove(key_type const &k);  // удаление данных с заданным ключом
+
+  // поиск по ключу: итератор на элемент или end()
+  template <typename K = key_type>
+  iterator find(K const &k) const;
+  // первый элемент с ключом не меньше k
+  template <typename K = key_type>
+  iterator lower_bound(K const &k) const;
+
+  //определение высоты дерева
+  size_type height() const noexcept;
+
+  //запрос прямого итератора, установленного на узел дерева с минимальным
+  //ключом
+  iterator begin() const;
+  //запрос «неустановленного» прямого итератора
+  iterator end() const;
+
+  allocator_type get_allocator() const;
+
+ private:
+  struct Node {
+    key_type key;
+    value_type data;
+    size_type height = 1;
+    Node *left = nullptr;
+    Node *right = nullptr;
+    // Число ссылок: из узлов-отцов всех версий и из корней деревьев
+    std::atomic<size_type> refs{1};
+
+    Node(key_type const &k, value_type const &v) : key(k), data(v) {}
+  };
+
+  using node_allocator = typename std::allocator_traits<
+      Alloc>::template rebind_alloc<Node>;
+  using node_traits = std::allocator_traits<node_allocator>;
+
+  // Высота АВЛ-дерева меньше 1.45 log2 (n + 2), т.е. для любого n,
+  // представимого size_type, меньше 96
+  static constexpr size_type max_height = 96;
+
+  Node *create_node(key_type const &k, value_type const &v);
+  void free_node(Node *node) noexcept;
+
+  static Node *retain(Node *node) noexcept;
+  void release(Node *node) noexcept;
+  Node *unshare(Node *node);
+
+  template <typename K>
+  Node const *find_node(K const &k) const;
+  static size_type height(Node const *node) noexcept;
+  static void update(Node *node) noexcept;
+  Node *rebalance(Node *node);
+  void retrace(Node **path[], size_type depth);
+
+  Node *left_rotate(Node *t);
+  Node *right_rotate(Node *t);
+
+  node_allocator alloc_;
+  size_type size_ = 0;
+  Node *root_ = nullptr;
+
+  class PersistentIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PersistentAvlBst::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type const *;
+    using reference = value_type const &;
+
+    PersistentIterator() = default;
+
+    reference operator*() const noexcept { return path_.back()->data; }
+    pointer operator->() const noexcept { return &path_.back()->data; }
+    key_type const &key() const noexcept { return path_.back()->key; }
+
+    // Переход к соседнему узлу: спуск по левой ветви правого поддерева или
+    // возврат к ближайшему предку, для которого узел лежал слева
+    PersistentIterator &operator++() {
+      Node const *node = path_.back()->right;
+      path_.pop_back();
+      descend_left(node);
+      return *this;
+    }
+
+    PersistentIterator operator++(int) {
+      auto it = *this;
+      ++(*this);
+      return it;
+    }
+
+    bool operator==(PersistentIterator const &other) const noexcept {
+      return current() == other.current();
+    }
+    bool operator!=(PersistentIterator const &other) const noexcept {
+      return current() != other.current();
+    }
+
+   private:
+    friend class PersistentAvlBst;
+
+    // Узлы пути от корня, для которых текущий узел лежит в левом
+    // поддереве, и сам текущий узел на вершине стека
+    std::vector<Node const *> path_;
+
+    Node const *current() const noexcept {
+      return path_.empty() ? nullptr : path_.back();
+    }
+
+    void descend_left(Node const *node) {
+      for (; node != nullptr; node = node->left) path_.push_back(node);
+    }
+  };
+};
+
+template <typename T_key, typename T_data, typename Alloc>
+PersistentAvlBst<T_key, T_data, Alloc>::PersistentAvlBst(
+    PersistentAvlBst const &b)
+    : alloc_(b.alloc_), size_(b.size_), root_(retain(b.root_)) {}
+
+template <typename T_key, typename T_data, typename Alloc>
+PersistentAvlBst<T_key, T_data, Alloc>::PersistentAvlBst(
+    PersistentAvlBst &&b) noexcept
+    : alloc_(b.alloc_), size_(b.size_), root_(b.root_) {
+  b.root_ = nullptr;
+  b.size_ = 0;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+PersistentAvlBst<T_key, T_data, Alloc> &
+PersistentAvlBst<T_key, T_data, Alloc>::operator=(PersistentAvlBst const &b) {
+  if (this != &b) {
+    PersistentAvlBst(b).swap(*this);
+  }
+  return *this;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+PersistentAvlBst<T_key, T_data, Alloc> &
+PersistentAvlBst<T_key, T_data, Alloc>::operator=(
+    PersistentAvlBst &&b) noexcept {
+  if (this != &b) {
+    PersistentAvlBst(std::move(b)).swap(*this);
+  }
+  return *this;
+}
+
+// Узлы обеих версий освобождаются одним аллокатором, поэтому он
+// обменивается вместе с деревом
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::swap(
+    PersistentAvlBst &other) noexcept {
+  std::swap(alloc_, other.alloc_);
+  std::swap(size_, other.size_);
+  std::swap(root_, other.root_);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::size_type
+PersistentAvlBst<T_key, T_data, Alloc>::size() const noexcept {
+  return size_;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::clear() noexcept {
+  release(root_);
+  root_ = nullptr;
+  size_ = 0;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+bool PersistentAvlBst<T_key, T_data, Alloc>::empty() const noexcept {
+  return size_ == 0;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+template <typename K>
+typename PersistentAvlBst<T_key, T_data, Alloc>::const_reference
+PersistentAvlBst<T_key, T_data, Alloc>::at(K const &k) const {
+  Node const *node = find_node(k);
+  if (node == nullptr) throw std::out_of_range("PersistentAvlBst::at");
+  return node->data;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+template <typename K>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node const *
+PersistentAvlBst<T_key, T_data, Alloc>::find_node(K const &k) const {
+  Node const *node = root_;
+  while (node != nullptr) {
+    if (k < node->key) {
+      node = node->left;
+    } else if (node->key < k) {
+      node = node->right;
+    } else {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+// Спуск идёт циклом: каждый узел пути перед изменением становится
+// собственным узлом этой версии, и ссылка на него сразу записывается в
+// отца. Адреса этих ссылок запоминаются для подъёма с балансировкой
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::insert(key_type const &k,
+                                                    value_type const &v) {
+  Node **path[max_height];
+  size_type depth = 0;
+  Node **link = &root_;
+
+  while (*link != nullptr) {
+    *link = unshare(*link);
+    Node *node = *link;
+    if (k < node->key) {
+      path[depth++] = link;
+      link = &node->left;
+    } else if (node->key < k) {
+      path[depth++] = link;
+      link = &node->right;
+    } else {  // if equal
+      node->data = v;
+      return;
+    }
+  }
+
+  *link = create_node(k, v);
+  size_++;
+  retrace(path, depth);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::remove(key_type const &k) {
+  // Без ключа путь не копируется
+  if (find_node(k) == nullptr) return;
+
+  Node **path[max_height];
+  size_type depth = 0;
+  Node **link = &root_;
+
+  while (true) {
+    *link = unshare(*link);
+    if (k < (*link)->key) {
+      path[depth++] = link;
+      link = &(*link)->left;
+    } else if ((*link)->key < k) {
+      path[depth++] = link;
+      link = &(*link)->right;
+    } else {
+      break;
+    }
+  }
+
+  Node *node = *link;
+  if (node->left == nullptr || node->right == nullptr) {
+    // Ссылка на единственного сына переходит от узла к его отцу
+    *link = node->left != nullptr ? node->left : node->right;
+    node->left = node->right = nullptr;
+    release(node);
+  } else {
+    // Ключ и данные преемника переносятся в узел, а сам преемник
+    // исключается из правого поддерева
+    path[depth++] = link;
+    Node **next = &node->right;
+    *next = unshare(*next);
+    while ((*next)->left != nullptr) {
+      path[depth++] = next;
+      next = &(*next)->left;
+      *next = unshare(*next);
+    }
+
+    Node *successor = *next;
+    *next = successor->right;
+    successor->right = nullptr;
+    node->key = std::move(successor->key);
+    node->data = std::move(successor->data);
+    release(successor);
+  }
+
+  size_--;
+  retrace(path, depth);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+template <typename K>
+typename PersistentAvlBst<T_key, T_data, Alloc>::iterator
+PersistentAvlBst<T_key, T_data, Alloc>::find(K const &k) const {
+  iterator it = lower_bound(k);
+  if (it != end() && k < it.key()) return end();
+  return it;
+}
+
+// Стек итератора собирается при спуске: в него попадают узлы, от которых
+// спуск ушёл влево
+template <typename T_key, typename T_data, typename Alloc>
+template <typename K>
+typename PersistentAvlBst<T_key, T_data, Alloc>::iterator
+PersistentAvlBst<T_key, T_data, Alloc>::lower_bound(K const &k) const {
+  iterator it;
+  Node const *node = root_;
+  while (node != nullptr) {
+    if (node->key < k) {
+      node = node->right;
+    } else {
+      it.path_.push_back(node);
+      if (!(k < node->key)) break;
+      node = node->left;
+    }
+  }
+  return it;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::size_type
+PersistentAvlBst<T_key, T_data, Alloc>::height() const noexcept {
+  return height(root_);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::iterator
+PersistentAvlBst<T_key, T_data, Alloc>::begin() const {
+  iterator it;
+  it.descend_left(root_);
+  return it;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::iterator
+PersistentAvlBst<T_key, T_data, Alloc>::end() const {
+  return iterator();
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::allocator_type
+PersistentAvlBst<T_key, T_data, Alloc>::get_allocator() const {
+  return allocator_type(alloc_);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::create_node(key_type const &k,
+                                                    value_type const &v) {
+  Node *node = node_traits::allocate(alloc_, 1);
+  try {
+    node_traits::construct(alloc_, node, k, v);
+  } catch (...) {
+    node_traits::deallocate(alloc_, node, 1);
+    throw;
+  }
+  return node;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::free_node(Node *node) noexcept {
+  node_traits::destroy(alloc_, node);
+  node_traits::deallocate(alloc_, node, 1);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::retain(Node *node) noexcept {
+  if (node != nullptr) node->refs.fetch_add(1, std::memory_order_relaxed);
+  return node;
+}
+
+// Снятие ссылки. Узел, на который больше никто не ссылается, освобождается
+// вместе со ссылками на сыновей. Глубина рекурсии — высота дерева
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::release(Node *node) noexcept {
+  while (node != nullptr &&
+         node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    release(node->left);
+    Node *right = node->right;
+    free_node(node);
+    node = right;
+  }
+}
+
+// Собственный узел этой версии вместо node: сам node, если других ссылок
+// на него нет, иначе его копия, разделяющая с ним сыновей. Ссылка на node
+// переходит к результату
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::unshare(Node *node) {
+  if (node->refs.load(std::memory_order_acquire) == 1) return node;
+
+  Node *copy = create_node(node->key, node->data);
+  copy->height = node->height;
+  copy->left = retain(node->left);
+  copy->right = retain(node->right);
+  release(node);
+  return copy;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::size_type
+PersistentAvlBst<T_key, T_data, Alloc>::height(Node const *node) noexcept {
+  return (node == nullptr ? 0 : node->height);
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::update(Node *node) noexcept {
+  node->height = 1 + std::max(height(node->left), height(node->right));
+}
+
+// Пересчёт высоты собственного узла и, при нарушении баланса, поворот.
+// Поворачиваемый сын тоже становится собственным: после вставки он и так
+// лежит на скопированном пути, после удаления может быть скопирован
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::rebalance(Node *node) {
+  update(node);
+  if (height(node->left) > height(node->right) + 1) {
+    if (height(node->left->left) < height(node->left->right)) {
+      node->left = unshare(node->left);
+      node->left = left_rotate(node->left);
+    }
+    return right_rotate(node);
+  }
+  if (height(node->right) > height(node->left) + 1) {
+    if (height(node->right->right) < height(node->right->left)) {
+      node->right = unshare(node->right);
+      node->right = right_rotate(node->right);
+    }
+    return left_rotate(node);
+  }
+  return node;
+}
+
+// Подъём по запомненным ссылкам с балансировкой. Как и в AvlBst,
+// прекращается, когда высота поддерева не изменилась
+template <typename T_key, typename T_data, typename Alloc>
+void PersistentAvlBst<T_key, T_data, Alloc>::retrace(Node **path[],
+                                                     size_type depth) {
+  while (depth > 0) {
+    Node **link = path[--depth];
+    size_type old_height = (*link)->height;
+    *link = rebalance(*link);
+    if ((*link)->height == old_height) return;
+  }
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::left_rotate(Node *t) {
+  t->right = unshare(t->right);
+  Node *u = t->right;
+  t->right = u->left;
+  u->left = t;
+  update(t);
+  update(u);
+  return u;
+}
+
+template <typename T_key, typename T_data, typename Alloc>
+typename PersistentAvlBst<T_key, T_data, Alloc>::Node *
+PersistentAvlBst<T_key, T_data, Alloc>::right_rotate(Node *t) {
+  t->left = unshare(t->left);
+  Node *u = t->left;
+  t->left = u->right;
+  u->right = t;
+  update(t);
+  update(u);
+  return u;
+}
+
+#endif  // PERSISTENT_AVL_BSTREE_H_